@@ -0,0 +1,367 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "thorin/world.h"
+#include "thorin/analyses/schedule.h"
+#include "thorin/analyses/scope.h"
+#include "thorin/be/c.h"
+#include "thorin/transform/partial_evaluation.h"
+#include "thorin/util/memory_stats.h"
+
+#ifdef THORIN_BENCH_LLVM
+#include "thorin/be/llvm/cpu.h"
+#endif
+
+using namespace thorin;
+
+typedef std::chrono::steady_clock Clock;
+
+//------------------------------------------------------------------------------
+
+/*
+ * generators
+ *
+ * Each one builds a world that stresses a particular part of thorin.
+ * The amount of code grows linearly with @c scale.
+ */
+
+static const FnType* ret_type(World& w) { return w.fn_type({w.mem_type(), w.type_qs32()}); }
+
+static Continuation* function(World& w, const std::string& name, std::vector<const Type*> params) {
+    params.insert(params.begin(), w.mem_type());
+    params.push_back(ret_type(w));
+    auto f = w.continuation(w.fn_type(params), {name});
+    f->make_external();
+    return f;
+}
+
+/// Emits a loop nest of @p depth loops running from 0 to @p n at @p from - afterwards @p done is called with the sum of all counters.
+static void nest(World& w, Continuation* from, const Def* mem, const Def* acc, const Def* n, const Def* done, size_t depth) {
+    auto i32 = w.type_qs32();
+    if (depth == 0) {
+        from->jump(done, {mem, w.arithop_add(acc, w.literal_qs32(1, {}))});
+        return;
+    }
+
+    auto head  = w.continuation(w.fn_type({w.mem_type(), i32, i32}), {"head"});
+    auto body  = w.continuation(w.fn_type(), {"body"});
+    auto exit  = w.continuation(w.fn_type(), {"exit"});
+    auto latch = w.continuation(ret_type(w), {"latch"});
+    auto i = head->param(1);
+    from->jump(head, {mem, w.literal_qs32(0, {}), acc});
+    head->branch(w.cmp_lt(i, n), body, exit);
+    nest(w, body, head->param(0), w.arithop_add(head->param(2), i), n, latch, depth - 1);
+    latch->jump(head, {latch->param(0), w.arithop_add(i, w.literal_qs32(1, {})), latch->param(1)});
+    exit->jump(done, {head->param(0), head->param(2)});
+}
+
+/// Functions with deeply nested loops.
+static void loop_nests(World& w, size_t scale) {
+    for (size_t k = 0; k != 16 * scale; ++k) {
+        auto f = function(w, "nest" + std::to_string(k), {w.type_qs32()});
+        nest(w, f, f->param(0), w.literal_qs32(k, {}), f->param(1), f->param(2), 8);
+    }
+}
+
+/// Functions that consist of a huge @p Match.
+static void big_matches(World& w, size_t scale) {
+    for (size_t k = 0; k != 4 * scale; ++k) {
+        auto f = function(w, "match" + std::to_string(k), {w.type_qs32()});
+        auto x = f->param(1);
+        auto otherwise = w.continuation(w.fn_type(), {"otherwise"});
+        otherwise->jump(f->param(2), {f->param(0), w.literal_qs32(0, {})});
+
+        std::vector<const Def*> patterns;
+        std::vector<Continuation*> cases;
+        for (s32 i = 0; i != 256; ++i) {
+            auto c = w.continuation(w.fn_type(), {"case"});
+            c->jump(f->param(2), {f->param(0), w.arithop_add(w.arithop_mul(x, w.literal_qs32(i, {})), w.literal_qs32(i + k, {}))});
+            patterns.push_back(w.literal_qs32(i, {}));
+            cases.push_back(c);
+        }
+        f->match(x, otherwise, patterns, cases);
+    }
+}
+
+/// Functions with long chains of arithmetic.
+static void straight_lines(World& w, size_t scale) {
+    static const ArithOpTag tags[] = { ArithOp_add, ArithOp_mul, ArithOp_xor, ArithOp_sub };
+    for (size_t k = 0; k != 8 * scale; ++k) {
+        auto f = function(w, "line" + std::to_string(k), {w.type_qs32(), w.type_qs32()});
+        const Def* v = f->param(1);
+        for (s32 i = 0; i != 128; ++i) {
+            v = w.arithop(tags[i % 4], v, f->param(1 + i % 2));
+            v = w.arithop_add(v, w.literal_qs32(i, {}));
+        }
+        f->jump(f->param(3), {f->param(0), v});
+    }
+}
+
+/**
+ * A higher-order @c range(lo, hi, body, ret) as found in libraries, which calls @c body for each index.
+ * Its filter specializes it for each @c body and @c ret during @p partial_evaluation.
+ */
+static void higher_order(World& w, size_t scale) {
+    auto i32 = w.type_qs32();
+    auto mem_fn = w.fn_type({w.mem_type()});
+    auto body_type = w.fn_type({w.mem_type(), i32, mem_fn});
+    auto range = w.continuation(w.fn_type({w.mem_type(), i32, i32, body_type, mem_fn}), {"range"});
+    auto lo = range->param(1), hi = range->param(2);
+    auto yes = w.continuation(w.fn_type(), {"yes"});
+    auto no  = w.continuation(w.fn_type(), {"no"});
+    auto next = w.continuation(mem_fn, {"next"});
+    range->branch(w.cmp_lt(lo, hi), yes, no);
+    yes->jump(range->param(3), {range->param(0), lo, next});
+    next->jump(range, {next->param(0), w.arithop_add(lo, w.literal_qs32(1, {})), hi, range->param(3), range->param(4)});
+    no->jump(range->param(4), {range->param(0)});
+    auto f = w.literal_bool(false, {}), t = w.literal_bool(true, {});
+    range->set_filter({f, f, f, t, t});
+
+    auto ptr = w.ptr_type(i32);
+    for (size_t k = 0; k != 64 * scale; ++k) {
+        auto user = function(w, "user" + std::to_string(k), {ptr, i32});
+        auto body = w.continuation(body_type, {"lambda"});
+        auto load = w.load(body->param(0), user->param(1));
+        auto val = w.arithop_add(w.extract(load, 1), w.arithop_mul(body->param(1), w.literal_qs32(k, {})));
+        body->jump(body->param(2), {w.store(w.extract(load, 0_u32), user->param(1), val)});
+
+        auto done = w.continuation(mem_fn, {"done"});
+        auto result = w.load(done->param(0), user->param(1));
+        done->jump(user->param(3), {w.extract(result, 0_u32), w.extract(result, 1)});
+        user->jump(range, {user->param(0), w.literal_qs32(0, {}), user->param(2), body, done});
+    }
+}
+
+/// A long call chain of small functions - every eighth one is external.
+static void many_functions(World& w, size_t scale) {
+    auto i32 = w.type_qs32();
+    Continuation* prev = nullptr;
+    for (size_t k = 0; k != 512 * scale; ++k) {
+        auto g = w.continuation(w.fn_type({w.mem_type(), i32, ret_type(w)}), {"small" + std::to_string(k)});
+        if (k % 8 == 0)
+            g->make_external();
+        auto x = g->param(1);
+        if (prev == nullptr) {
+            g->jump(g->param(2), {g->param(0), x});
+        } else {
+            auto cont = w.continuation(ret_type(w), {"cont"});
+            g->jump(prev, {g->param(0), w.arithop_add(x, w.literal_qs32(k, {})), cont});
+            cont->jump(g->param(2), {cont->param(0), w.arithop_mul(cont->param(1), x)});
+        }
+        prev = g;
+    }
+}
+
+/// Functions with long chains of loads and stores through a few slots and a pointer parameter.
+static void memory_chains(World& w, size_t scale) {
+    auto i32 = w.type_qs32();
+    auto ptr = w.ptr_type(w.indefinite_array_type(i32));
+    for (size_t k = 0; k != 8 * scale; ++k) {
+        auto f = function(w, "mem" + std::to_string(k), {ptr, i32});
+        auto enter = w.enter(f->param(0));
+        auto mem = w.extract(enter, 0_u32);
+        const Def* slots[8];
+        for (auto& slot : slots)
+            slot = w.slot(i32, w.extract(enter, 1));
+
+        const Def* v = f->param(2);
+        for (s32 i = 0; i != 64; ++i) {
+            mem = w.store(mem, slots[i % 8], v);
+            auto load = w.load(mem, slots[(i * 3) % 8]);
+            mem = w.extract(load, 0_u32);
+            auto elem = w.lea(f->param(1), w.literal_qs32(i, {}), {});
+            auto arg = w.load(mem, elem);
+            mem = w.store(w.extract(arg, 0_u32), elem, w.arithop_add(w.extract(load, 1), v));
+            v = w.arithop_add(v, w.extract(arg, 1));
+        }
+        f->jump(f->param(3), {mem, v});
+    }
+}
+
+struct Generator {
+    const char* name;
+    std::function<void(World&, size_t)> generate;
+};
+
+static const Generator generators[] = {
+    { "loop_nests",     loop_nests     },
+    { "big_matches",    big_matches    },
+    { "straight_lines", straight_lines },
+    { "higher_order",   higher_order   },
+    { "many_functions", many_functions },
+    { "memory_chains",  memory_chains  },
+};
+
+//------------------------------------------------------------------------------
+
+/*
+ * components
+ *
+ * The components run in this order on a freshly generated world - so each one sees the result of the previous ones.
+ * Components that work on each @p Scope only measure the work itself and not the construction of the @p Scope.
+ */
+
+struct Component {
+    const char* name;
+    /// Runs the component on @p world and returns the measured time in seconds.
+    std::function<double(World&)> run;
+};
+
+template<class F>
+static double measure(F f) {
+    auto start = Clock::now();
+    f();
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+static const Component components[] = {
+    { "partial_evaluation", [] (World& world) { return measure([&] { partial_evaluation(world); }); } },
+    { "cleanup",            [] (World& world) { return measure([&] { world.cleanup(); }); } },
+    { "opt",                [] (World& world) { return measure([&] { world.opt(); }); } },
+    { "Scope::for_each",    [] (World& world) {
+        return measure([&] {
+            size_t num = 0;
+            Scope::for_each(world, [&] (const Scope& scope) { num += scope.defs().size(); });
+        });
+    } },
+    { "cfg",                [] (World& world) {
+        double time = 0.0;
+        Scope::for_each(world, [&] (const Scope& scope) { time += measure([&] { scope.f_cfg(); }); });
+        return time;
+    } },
+    { "Schedule",           [] (World& world) {
+        double time = 0.0;
+        Scope::for_each(world, [&] (const Scope& scope) {
+            scope.f_cfg();
+            time += measure([&] { Schedule schedule(scope, Schedule::Smart); });
+        });
+        return time;
+    } },
+    { "emit_c",             [] (World& world) {
+        // the C backend treats all external continuations as kernels
+        Cont2Config kernel_config;
+        for (auto continuation : world.externals())
+            kernel_config.emplace(continuation, std::make_unique<GPUKernelConfig>(std::make_tuple(1, 1, 1)));
+        std::ostringstream os;
+        return measure([&] { emit_c(world, kernel_config, os, Lang::C99, false); });
+    } },
+#ifdef THORIN_BENCH_LLVM
+    { "emit_llvm",          [] (World& world) {
+        return measure([&] { CPUCodeGen(world).emit(0, false); });
+    } },
+#endif
+};
+
+//------------------------------------------------------------------------------
+
+struct Statistics {
+    double min, median, mean, stddev;
+
+    Statistics(std::vector<double> samples) {
+        std::sort(samples.begin(), samples.end());
+        auto n = samples.size();
+        min = samples.front();
+        median = n % 2 ? samples[n / 2] : (samples[n / 2 - 1] + samples[n / 2]) / 2.0;
+        mean = 0.0;
+        for (auto sample : samples)
+            mean += sample;
+        mean /= n;
+        stddev = 0.0;
+        for (auto sample : samples)
+            stddev += (sample - mean) * (sample - mean);
+        stddev = n > 1 ? std::sqrt(stddev / (n - 1)) : 0.0;
+    }
+};
+
+static void usage() {
+    std::cout << "usage: thorin_bench [-r <repetitions>] [-s <scale>] [-m] [<generator>...]" << std::endl;
+    std::cout << "generators:";
+    for (const auto& generator : generators)
+        std::cout << " " << generator.name;
+    std::cout << std::endl;
+}
+
+int main(int argc, char** argv) {
+    size_t repetitions = 5, scale = 1;
+    bool memory = false;
+    std::vector<std::string> selected;
+    for (int i = 1; i < argc; ++i) {
+        if ((!strcmp(argv[i], "-r") || !strcmp(argv[i], "-s")) && i + 1 < argc) {
+            auto value = std::strtoul(argv[i + 1], nullptr, 10);
+            if (value == 0) {
+                usage();
+                return EXIT_FAILURE;
+            }
+            (argv[i][1] == 'r' ? repetitions : scale) = value;
+            ++i;
+        } else if (!strcmp(argv[i], "-m")) {
+            memory = true;
+        } else if (!strcmp(argv[i], "-h") || !strcmp(argv[i], "--help")) {
+            usage();
+            return EXIT_SUCCESS;
+        } else {
+            selected.emplace_back(argv[i]);
+        }
+    }
+
+    for (const auto& name : selected) {
+        if (std::none_of(std::begin(generators), std::end(generators), [&] (const Generator& g) { return name == g.name; })) {
+            std::cerr << "unknown generator '" << name << "'" << std::endl;
+            usage();
+            return EXIT_FAILURE;
+        }
+    }
+
+    std::cout << std::left << std::setw(16) << "generator" << std::setw(20) << "component" << std::right
+              << std::setw(12) << "min [ms]" << std::setw(12) << "median [ms]" << std::setw(12) << "mean [ms]"
+              << std::setw(12) << "stddev [ms]" << std::endl;
+    std::cout << std::fixed << std::setprecision(3);
+
+    for (const auto& generator : generators) {
+        if (!selected.empty() && std::find(selected.begin(), selected.end(), generator.name) == selected.end())
+            continue;
+
+        auto num_components = sizeof(components) / sizeof(components[0]);
+        std::vector<std::vector<double>> samples(num_components + 1);
+        std::ostringstream memory_os;
+        for (size_t r = 0; r != repetitions + 1; ++r) { // the first run only warms up
+            World world(generator.name);
+            double time = measure([&] { generator.generate(world, scale); });
+            if (r != 0)
+                samples.back().push_back(time);
+            if (memory && r == repetitions)
+                world.memory_stats().dump(memory_os << std::endl << generator.name << " after construction:" << std::endl);
+            for (size_t c = 0; c != num_components; ++c) {
+                time = components[c].run(world);
+                if (r != 0)
+                    samples[c].push_back(time);
+                if (memory && r == repetitions && !strcmp(components[c].name, "opt"))
+                    world.memory_stats().dump(memory_os << std::endl << generator.name << " after opt:" << std::endl);
+            }
+        }
+
+        auto print = [&] (const char* name, const std::vector<double>& samples) {
+            Statistics stats(samples);
+            std::cout << std::left << std::setw(16) << generator.name << std::setw(20) << name << std::right
+                      << std::setw(12) << stats.min    * 1000.0 << std::setw(12) << stats.median * 1000.0
+                      << std::setw(12) << stats.mean   * 1000.0 << std::setw(12) << stats.stddev * 1000.0 << std::endl;
+        };
+
+        print("construction", samples.back());
+        for (size_t c = 0; c != num_components; ++c)
+            print(components[c].name, samples[c]);
+        std::cout << memory_os.str();
+    }
+
+    return EXIT_SUCCESS;
+}
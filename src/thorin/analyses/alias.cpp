@@ -0,0 +1,112 @@
+#include "thorin/analyses/alias.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "thorin/primop.h"
+
+namespace thorin {
+
+/// Yields the object @p ptr points into and collects the @p LEA indices from the object outwards.
+static const Def* access_path(const Def* ptr, std::vector<const Def*>& indices, bool& exact) {
+    while (true) {
+        if (auto lea = ptr->isa<LEA>()) {
+            indices.push_back(lea->index());
+            ptr = lea->ptr();
+        } else if (auto bitcast = ptr->isa<Bitcast>()) {
+            exact = false;
+            ptr = bitcast->from();
+        } else {
+            break;
+        }
+    }
+    std::reverse(indices.begin(), indices.end());
+    return ptr;
+}
+
+const Def* base_object(const Def* ptr) {
+    std::vector<const Def*> indices;
+    bool exact = true;
+    return access_path(ptr, indices, exact);
+}
+
+bool is_object(const Def* def) {
+    return def->isa<Slot>() || def->isa<Global>() || Alloc::is_out_ptr(def);
+}
+
+static bool only_accessed(const Def* ptr) {
+    for (auto use : ptr->uses()) {
+        if (use->isa<LEA>() || use->isa<Bitcast>()) {
+            if (!only_accessed(use))
+                return false;
+        } else if (!use->isa<Load>() && !(use->isa<Store>() && use.index() == 1)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool is_local(const Def* object) {
+    return (object->isa<Slot>() || Alloc::is_out_ptr(object)) && only_accessed(object);
+}
+
+bool may_alias(const Def* a, const Def* b) {
+    if (a == b)
+        return true;
+
+    std::vector<const Def*> path_a, path_b;
+    bool exact = true;
+    auto object_a = access_path(a, path_a, exact);
+    auto object_b = access_path(b, path_b, exact);
+
+    if (object_a != object_b) {
+        if (is_object(object_a) && is_object(object_b))
+            return false;
+        // nothing else may point into a local object - in particular no param
+        return !is_local(object_a) && !is_local(object_b);
+    }
+
+    // a bitcast may reinterpret the layout
+    if (!exact)
+        return true;
+
+    for (size_t i = 0, e = std::min(path_a.size(), path_b.size()); i != e; ++i) {
+        auto index_a = path_a[i], index_b = path_b[i];
+        if (index_a == index_b)
+            continue;
+        // two different constants address disjoint elements - anything else may overlap
+        if (!index_a->isa<PrimLit>() || !index_b->isa<PrimLit>())
+            return true;
+        if (primlit_value<u64>(index_a) != primlit_value<u64>(index_b))
+            return false;
+    }
+
+    return true;
+}
+
+u64 slot_size(const Type* type) {
+    static const u64 unknown = u64(-1);
+
+    if (auto prim_type = type->isa<PrimType>())
+        return prim_type->length();
+    if (type->isa<PtrType>())
+        return 1;
+    if (auto array_type = type->isa<DefiniteArrayType>()) {
+        auto elem = slot_size(array_type->elem_type());
+        return elem == unknown || array_type->dim() > max_slot_size ? unknown : elem * array_type->dim();
+    }
+    if (type->isa<TupleType>() || type->isa<StructType>()) {
+        u64 result = 0;
+        for (auto op : type->ops()) {
+            auto elem = slot_size(op);
+            if (elem == unknown)
+                return unknown;
+            result += elem;
+        }
+        return result;
+    }
+    return unknown;
+}
+
+}
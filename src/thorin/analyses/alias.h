@@ -0,0 +1,33 @@
+#ifndef THORIN_ANALYSES_ALIAS_H
+#define THORIN_ANALYSES_ALIAS_H
+
+#include "thorin/type.h"
+
+namespace thorin {
+
+class Def;
+
+/// Strips all @p LEA%s and @p Bitcast%s off @p ptr and yields the pointer to the underlying object.
+const Def* base_object(const Def* ptr);
+
+/// Is @p def a @p Slot, a @p Global or the pointer of an @p Alloc? Two distinct objects of this kind never overlap.
+bool is_object(const Def* def);
+
+/**
+ * Is @p object a @p Slot or the pointer of an @p Alloc whose address is only used to access memory?
+ * In this case, no other pointer refers to it and callees can't access it.
+ */
+bool is_local(const Def* object);
+
+/// Conservatively checks whether @p a and @p b may point to overlapping memory.
+bool may_alias(const Def* a, const Def* b);
+
+/// Only @p Alloc%s of at most this many scalars are turned into @p Slot%s - larger buffers stay on the heap.
+constexpr u64 max_slot_size = 64;
+
+/// Number of scalars in @p type - @c u64(-1) if unknown or if it has more than @p max_slot_size elements.
+u64 slot_size(const Type* type);
+
+}
+
+#endif
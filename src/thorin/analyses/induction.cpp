@@ -0,0 +1,153 @@
+#include "thorin/analyses/induction.h"
+
+#include "thorin/primop.h"
+#include "thorin/world.h"
+#include "thorin/analyses/scope.h"
+
+namespace thorin {
+
+Induction::Induction(const Scope& scope, const LoopTree<true>::Head* head)
+    : scope_(scope)
+{
+    if (head->is_root() || head->num_cf_nodes() != 1)
+        return; // irreducible
+    auto header = head->cf_nodes().front()->continuation();
+    if (header == scope.entry())
+        return;
+
+    collect_blocks(head);
+    for (auto use : header->uses()) {
+        auto caller = use->isa_continuation();
+        if (caller == nullptr || use.index() != 0 || !scope.contains(caller))
+            return;
+        if (blocks_.contains(caller))
+            latches_.push_back(caller);
+        else
+            entries_.push_back(caller);
+    }
+    if (entries_.empty() || latches_.empty())
+        return;
+    header_ = header;
+
+    for (auto param : header->params()) {
+        auto type = param->type()->isa<PrimType>();
+        if (type == nullptr || type->is_vector() || !is_type_i(type))
+            continue;
+
+        const Def* cur = nullptr;
+        for (auto latch : latches_) {
+            auto s = step(param, latch->arg(param->index()));
+            if (s == nullptr || (cur != nullptr && s != cur)) {
+                cur = nullptr;
+                break;
+            }
+            cur = s;
+        }
+        if (cur != nullptr)
+            vars_.push_back({param, cur});
+    }
+}
+
+void Induction::collect_blocks(const LoopTree<true>::Node* node) {
+    if (auto leaf = node->isa<LoopTree<true>::Leaf>())
+        blocks_.insert(leaf->cf_node()->continuation());
+    else {
+        for (const auto& child : node->as<LoopTree<true>::Head>()->children())
+            collect_blocks(child.get());
+    }
+}
+
+/// Yields @c c if @p arg is <tt>param + c</tt> or <tt>param - -c</tt>.
+const Def* Induction::step(const Param* param, const Def* arg) const {
+    auto arithop = arg->isa<ArithOp>();
+    if (arithop == nullptr)
+        return nullptr;
+
+    if (arithop->arithop_tag() == ArithOp_add) {
+        if (arithop->lhs() == param && arithop->rhs()->isa<PrimLit>())
+            return arithop->rhs();
+        if (arithop->rhs() == param && arithop->lhs()->isa<PrimLit>())
+            return arithop->lhs();
+    } else if (arithop->arithop_tag() == ArithOp_sub) {
+        if (arithop->lhs() == param && arithop->rhs()->isa<PrimLit>())
+            return param->world().arithop_minus(arithop->rhs(), arithop->debug());
+    }
+    return nullptr;
+}
+
+const Induction::Var* Induction::var(const Def* def) const {
+    for (const auto& var : vars_) {
+        if (var.param == def)
+            return &var;
+    }
+    return nullptr;
+}
+
+const Def* Induction::init(const Param* param) const {
+    const Def* result = nullptr;
+    for (auto entry : entries_) {
+        auto arg = entry->arg(param->index());
+        if (result != nullptr && arg != result)
+            return nullptr;
+        result = arg;
+    }
+    return result;
+}
+
+bool Induction::is_invariant(const Def* def) const {
+    if (auto param = def->isa<Param>())
+        return !blocks_.contains(param->continuation());
+    if (def->isa_continuation())
+        return true;
+
+    auto i = invariant_.find(def);
+    if (i != invariant_.end())
+        return i->second;
+
+    bool result = true;
+    for (auto op : def->ops())
+        result &= is_invariant(op);
+    return invariant_[def] = result;
+}
+
+bool Induction::trip_count(u64& count, u64 limit) const {
+    if (!is_valid() || header_->callee() != header_->world().branch())
+        return false;
+
+    auto t = header_->arg(1)->isa_continuation();
+    auto f = header_->arg(2)->isa_continuation();
+    if (t == nullptr || f == nullptr || blocks_.contains(t) == blocks_.contains(f))
+        return false;
+    bool stay = blocks_.contains(t); // value of the condition that stays in the loop
+
+    auto cmp = header_->arg(0)->isa<Cmp>();
+    if (cmp == nullptr)
+        return false;
+    auto var = this->var(cmp->lhs());
+    auto bound = cmp->rhs();
+    if (var == nullptr) {
+        var = this->var(cmp->rhs());
+        bound = cmp->lhs();
+    }
+    if (var == nullptr || !bound->isa<PrimLit>())
+        return false;
+    auto val = init(var->param);
+    if (val == nullptr || !val->isa<PrimLit>())
+        return false;
+
+    // simulate the loop: all values are literals and fold
+    auto& world = header_->world();
+    for (count = 0; count <= limit; ++count) {
+        auto lhs = cmp->lhs() == var->param ? val : bound;
+        auto rhs = cmp->lhs() == var->param ? bound : val;
+        auto cond = world.cmp(cmp->cmp_tag(), lhs, rhs)->isa<PrimLit>();
+        if (cond == nullptr)
+            return false;
+        if (cond->value().get_bool() != stay)
+            return true;
+        val = world.arithop_add(val, var->step);
+    }
+    return false;
+}
+
+}
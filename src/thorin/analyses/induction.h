@@ -0,0 +1,63 @@
+#ifndef THORIN_ANALYSES_INDUCTION_H
+#define THORIN_ANALYSES_INDUCTION_H
+
+#include "thorin/continuation.h"
+#include "thorin/analyses/looptree.h"
+
+namespace thorin {
+
+class Scope;
+
+/**
+ * Affine induction variables of a loop.
+ * Only loops with a single header that is merely called are analyzed - so all entries into the loop and all back edges
+ * are known.
+ */
+class Induction {
+public:
+    Induction(const Induction&) = delete;
+    Induction& operator=(Induction) = delete;
+
+    /// A @p Param of the header that is incremented by the same constant on all back edges.
+    struct Var {
+        const Param* param;
+        const Def* step; ///< @p PrimLit added on each iteration
+    };
+
+    Induction(const Scope& scope, const LoopTree<true>::Head* head);
+
+    const Scope& scope() const { return scope_; }
+    bool is_valid() const { return header_ != nullptr; }
+    Continuation* header() const { return header_; }
+    const ContinuationSet& blocks() const { return blocks_; }
+    const std::vector<Continuation*>& entries() const { return entries_; } ///< calls of the header from outside the loop
+    const std::vector<Continuation*>& latches() const { return latches_; } ///< calls of the header from within the loop
+    const std::vector<Var>& vars() const { return vars_; }
+    const Var* var(const Def* def) const;
+    /// The value of @p param passed by all entries into the loop - @c nullptr if they pass different values.
+    const Def* init(const Param* param) const;
+    /// Does @p def not depend on any @p Param of the loop?
+    bool is_invariant(const Def* def) const;
+    /**
+     * Number of iterations if the header leaves the loop by comparing an induction variable with a constant initial value
+     * to a constant bound - @c false if this isn't the case or the loop runs more than @p limit times.
+     * The loop may still be left earlier through other exits.
+     */
+    bool trip_count(u64& count, u64 limit) const;
+
+private:
+    void collect_blocks(const LoopTree<true>::Node*);
+    const Def* step(const Param*, const Def* arg) const;
+
+    const Scope& scope_;
+    Continuation* header_ = nullptr;
+    ContinuationSet blocks_;
+    std::vector<Continuation*> entries_;
+    std::vector<Continuation*> latches_;
+    std::vector<Var> vars_;
+    mutable DefMap<bool> invariant_;
+};
+
+}
+
+#endif
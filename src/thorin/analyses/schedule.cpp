@@ -9,6 +9,7 @@
 #include "thorin/analyses/looptree.h"
 #include "thorin/analyses/scope.h"
 #include "thorin/util/log.h"
+#include "thorin/util/trace.h"
 
 namespace thorin {
 
@@ -224,6 +225,9 @@ Schedule::Schedule(const Scope& scope, Tag tag)
     , blocks_(cfa().size())
     , tag_(tag)
 {
+    Trace::Span span("schedule");
+    if (span)
+        span.name("Schedule " + scope.entry()->unique_name()).arg("defs", scope.defs().size());
     block_schedule();
     Scheduler(scope, *this);
     verify();
@@ -9,6 +9,7 @@
 #include "thorin/analyses/domtree.h"
 #include "thorin/analyses/looptree.h"
 #include "thorin/analyses/schedule.h"
+#include "thorin/util/trace.h"
 
 namespace thorin {
 
@@ -102,10 +103,38 @@ const ParamSet& Scope::free_params() const {
     return *free_params_;
 }
 
+bool Scope::is_modified_since(size_t epoch) const {
+    for (auto def : defs_) {
+        if (auto continuation = def->isa_continuation()) {
+            if (continuation->is_modified_since(epoch))
+                return true;
+        }
+    }
+
+    return false;
+}
+
 const CFA& Scope::cfa() const { return lazy_init(this, cfa_); }
 const F_CFG& Scope::f_cfg() const { return cfa().f_cfg(); }
 const B_CFG& Scope::b_cfg() const { return cfa().b_cfg(); }
 
+/// Invokes @p f on all @p Continuation%s reachable from the free @p Def%s of @p scope without passing another one.
+static void for_each_free_continuation(const Scope& scope, std::function<void(Continuation*)> f) {
+    unique_queue<DefSet> def_queue;
+    for (auto def : scope.free())
+        def_queue.push(def);
+
+    while (!def_queue.empty()) {
+        auto def = def_queue.pop();
+        if (auto continuation = def->isa_continuation())
+            f(continuation);
+        else {
+            for (auto op : def->ops())
+                def_queue.push(op);
+        }
+    }
+}
+
 template<bool elide_empty>
 void Scope::for_each(const World& world, std::function<void(Scope&)> f) {
     unique_queue<ContinuationSet> continuation_queue;
@@ -119,28 +148,108 @@ void Scope::for_each(const World& world, std::function<void(Scope&)> f) {
         auto continuation = continuation_queue.pop();
         if (elide_empty && continuation->empty())
             continue;
+        Trace::Span span("scope");
         Scope scope(continuation);
+        if (span)
+            span.name(continuation->unique_name()).arg("defs", scope.defs().size());
         f(scope);
+        for_each_free_continuation(scope, [&] (Continuation* continuation) { continuation_queue.push(continuation); });
+    }
+}
 
+void Scope::for_each(const World& world, ScopeCache& cache, size_t epoch, std::function<void(Scope&)> f) {
+    // entries of the cached Scopes which contain a modified Continuation - we have to build all Scopes if we can't tell
+    bool known = !cache.continuations_.empty() && world.is_recorded_since(epoch);
+    ContinuationSet dirty;
+    if (known) {
+        auto mark = [&] (Continuation* continuation) {
+            auto i = cache.entries_.find(continuation);
+            if (i != cache.entries_.end())
+                dirty.emplace(i->second);
+        };
+
+        // a modified Continuation may also join a Scope by using a PrimOp which depends on it
         unique_queue<DefSet> def_queue;
-        for (auto def : scope.free())
-            def_queue.push(def);
+        for (auto continuation : world.modified_since(epoch)) {
+            mark(continuation);
+            for (auto op : continuation->ops()) {
+                if (op->isa<PrimOp>())
+                    def_queue.push(op);
+            }
+        }
 
         while (!def_queue.empty()) {
             auto def = def_queue.pop();
-            if (auto continuation = def->isa_continuation())
-                continuation_queue.push(continuation);
+            if (auto param = def->isa<Param>())
+                mark(param->continuation());
+            else if (auto continuation = def->isa_continuation())
+                mark(continuation);
             else {
                 for (auto op : def->ops())
                     def_queue.push(op);
             }
         }
     }
+
+    unique_queue<ContinuationSet> continuation_queue;
+    for (auto continuation : world.externals())
+        continuation_queue.push(continuation);
+
+    while (!continuation_queue.empty()) {
+        auto continuation = continuation_queue.pop();
+        if (continuation->empty())
+            continue;
+
+        auto i = cache.continuations_.find(continuation);
+        if (known && i != cache.continuations_.end() && !dirty.contains(continuation)) {
+            for (auto free : i->second)
+                continuation_queue.push(free);
+            continue;
+        }
+
+        Trace::Span span("scope");
+        Scope scope(continuation);
+        if (span)
+            span.name(continuation->unique_name()).arg("defs", scope.defs().size());
+        if (scope.is_modified_since(epoch))
+            f(scope);
+
+        for (auto def : scope.defs()) {
+            if (auto member = def->isa_continuation()) {
+                if (member != scope.exit())
+                    cache.entries_[member] = continuation;
+            }
+        }
+        auto& frees = cache.continuations_[continuation];
+        frees.clear();
+        for_each_free_continuation(scope, [&] (Continuation* free) {
+            frees.push_back(free);
+            continuation_queue.push(free);
+        });
+    }
 }
 
 template void Scope::for_each<true> (const World&, std::function<void(Scope&)>);
 template void Scope::for_each<false>(const World&, std::function<void(Scope&)>);
 
+void ScopeCache::forget(const ContinuationSet& dead) {
+    std::vector<Continuation*> keys;
+    for (const auto& p : entries_) {
+        if (dead.contains(p.first) || dead.contains(p.second))
+            keys.push_back(p.first);
+    }
+    for (auto key : keys)
+        entries_.erase(key);
+
+    keys.clear();
+    for (const auto& p : continuations_) {
+        if (dead.contains(p.first) || std::any_of(p.second.begin(), p.second.end(), [&] (Continuation* c) { return dead.contains(c); }))
+            keys.push_back(p.first);
+    }
+    for (auto key : keys)
+        continuations_.erase(key);
+}
+
 std::ostream& Scope::stream(std::ostream& os) const { return schedule(*this).stream(os); }
 void Scope::write_thorin(const char* filename) const { return schedule(*this).write_thorin(filename); }
 void Scope::thorin() const { schedule(*this).thorin(); }
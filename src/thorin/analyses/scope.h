@@ -15,6 +15,7 @@ typedef CFG<false> B_CFG;
 
 class CFA;
 class CFNode;
+class ScopeCache;
 
 /**
  * A @p Scope represents a region of @p Continuation%s which are live from the view of an @p entry @p Continuation.
@@ -48,6 +49,8 @@ public:
     const ParamSet& free_params() const;
     /// Are there any free @p Param%s within this @p Scope.
     bool has_free_params() const { return !free_params().empty(); }
+    /// Has any @p Continuation of this @p Scope been modified after @p epoch? See @p World::epoch.
+    bool is_modified_since(size_t epoch) const;
     //@}
 
     //@{ simple CFA to construct a CFG
@@ -70,6 +73,12 @@ public:
      */
     template<bool elide_empty = true>
     static void for_each(const World&, std::function<void(Scope&)>);
+    /**
+     * Like above but only visits the top-level Scope%s which have been modified after @p epoch.
+     * The others are skipped without building them if @p cache knows them and the @p World has recorded all
+     * modifications after @p epoch - see @p World::record_modified.
+     */
+    static void for_each(const World&, ScopeCache& cache, size_t epoch, std::function<void(Scope&)>);
 
 private:
     void run();
@@ -83,6 +92,19 @@ private:
     mutable std::unique_ptr<const CFA> cfa_;
 };
 
+/// Remembers the top-level @p Scope%s visited by @p Scope::for_each - so that unmodified ones needn't be built again.
+class ScopeCache {
+public:
+    /// Forgets everything about the @p Continuation%s in @p dead - invoke before deleting them.
+    void forget(const ContinuationSet& dead);
+
+private:
+    ContinuationMap<Continuation*> entries_;                     ///< entry of the top-level Scope of each Continuation
+    ContinuationMap<std::vector<Continuation*>> continuations_; ///< Continuation%s in the free Def%s of each entry's Scope
+
+    friend class Scope;
+};
+
 }
 
 #endif
@@ -8,6 +8,7 @@
 #include "thorin/analyses/scope.h"
 #include "thorin/util/log.h"
 #include "thorin/util/stream.h"
+#include "thorin/util/trace.h"
 #include "thorin/be/c.h"
 
 #include <cmath>
@@ -1363,7 +1364,10 @@ bool CCodeGen::is_texture_type(const Type* type) {
 
 //------------------------------------------------------------------------------
 
-void emit_c(World& world, const Cont2Config& kernel_config, std::ostream& stream, Lang lang, bool debug) { CCodeGen(world, kernel_config, stream, lang, debug).emit(); }
+void emit_c(World& world, const Cont2Config& kernel_config, std::ostream& stream, Lang lang, bool debug) {
+    Trace::Span span("emit", "emit_c");
+    CCodeGen(world, kernel_config, stream, lang, debug).emit();
+}
 
 //------------------------------------------------------------------------------
 
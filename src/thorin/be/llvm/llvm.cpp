@@ -44,6 +44,7 @@
 #include "thorin/transform/codegen_prepare.h"
 #include "thorin/util/array.h"
 #include "thorin/util/log.h"
+#include "thorin/util/trace.h"
 
 namespace thorin {
 
@@ -258,6 +259,9 @@ llvm::Function* CodeGen::emit_function_decl(Continuation* continuation) {
 }
 
 std::unique_ptr<llvm::Module>& CodeGen::emit(int opt, bool debug) {
+    Trace::Span span("emit");
+    if (span)
+        span.name("emit " + module_->getName().str());
     llvm::DICompileUnit* dicompile_unit;
     if (debug) {
         module_->addModuleFlag(llvm::Module::Warning, "Debug Info Version", llvm::DEBUG_METADATA_VERSION);
@@ -1027,19 +1031,29 @@ llvm::Value* CodeGen::emit_global(const Global* global) {
     return val;
 }
 
+/// A vector accessed through a pointer to its first element - see @p slp_vectorize - is only aligned like its elements.
+unsigned CodeGen::alignment(const Def* ptr) {
+    if (auto bitcast = ptr->isa<Bitcast>()) {
+        auto from = bitcast->from()->type()->isa<PtrType>();
+        auto elem = from ? from->pointee()->isa<PrimType>() : nullptr;
+        auto vector = ptr->type()->as<PtrType>()->pointee()->isa<PrimType>();
+        if (elem && vector && !elem->is_vector() && vector->is_vector() && elem->primtype_tag() == vector->primtype_tag())
+            return module_->getDataLayout().getABITypeAlignment(convert(elem));
+    }
+    return module_->getDataLayout().getABITypeAlignment(lookup(ptr)->getType()->getPointerElementType());
+}
+
 llvm::Value* CodeGen::emit_load(const Load* load) {
     auto ptr = lookup(load->ptr());
     auto result = irbuilder_.CreateLoad(ptr);
-    auto align = module_->getDataLayout().getABITypeAlignment(ptr->getType()->getPointerElementType());
-    result->setAlignment(llvm::MaybeAlign(align));
+    result->setAlignment(llvm::MaybeAlign(alignment(load->ptr())));
     return result;
 }
 
 llvm::Value* CodeGen::emit_store(const Store* store) {
     auto ptr = lookup(store->ptr());
     auto result = irbuilder_.CreateStore(lookup(store->val()), ptr);
-    auto align = module_->getDataLayout().getABITypeAlignment(ptr->getType()->getPointerElementType());
-    result->setAlignment(llvm::MaybeAlign(align));
+    result->setAlignment(llvm::MaybeAlign(alignment(store->ptr())));
     return result;
 }
 
@@ -48,6 +48,7 @@ protected:
     virtual llvm::FunctionType* convert_fn_type(Continuation*);
 
     virtual llvm::Value* emit_global(const Global*);
+    unsigned alignment(const Def* ptr);
     virtual llvm::Value* emit_load(const Load*);
     virtual llvm::Value* emit_store(const Store*);
     virtual llvm::Value* emit_lea(const LEA*);
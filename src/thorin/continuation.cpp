@@ -81,6 +81,17 @@ void Continuation::destroy_body() {
     resize(0);
 }
 
+void Continuation::touch() {
+    auto& world = this->world();
+    epoch_ = ++world.epoch_;
+    if (world.recorded_since_ != size_t(-1)) {
+        if (!world.modified_.empty() && world.modified_.back().second == this)
+            world.modified_.back().first = epoch_;
+        else
+            world.modified_.emplace_back(epoch_, this);
+    }
+}
+
 const FnType* Continuation::arg_fn_type() const {
     Array<const Type*> args(num_args());
     for (size_t i = 0, e = num_args(); i != e; ++i)
@@ -99,6 +110,7 @@ const Param* Continuation::append_param(const Type* param_type, Debug dbg) {
     set_type(param_type->table().fn_type(ops));              // update type
     auto param = world().param(param_type, this, size, dbg); // append new param
     params_.push_back(param);
+    touch();
 
     return param;
 }
@@ -177,6 +189,16 @@ void Continuation::make_internal() { return world().remove_external(this); }
 bool Continuation::is_external() const { return world().is_external(this); }
 bool Continuation::is_intrinsic() const { return intrinsic_ != Intrinsic::None; }
 bool Continuation::is_accelerator() const { return Intrinsic::_Accelerator_Begin <= intrinsic_ && intrinsic_ < Intrinsic::_Accelerator_End; }
+
+bool Continuation::has_known_calls() const {
+    if (is_external() || is_intrinsic())
+        return false;
+    for (auto use : uses()) {
+        if (use.index() != 0 || !use->isa_continuation())
+            return false;
+    }
+    return true;
+}
 void Continuation::set_intrinsic() {
     if      (name() == "cuda")                 intrinsic_ = Intrinsic::CUDA;
     else if (name() == "nvvm")                 intrinsic_ = Intrinsic::NVVM;
@@ -212,31 +234,16 @@ bool Continuation::is_returning() const { return type()->is_returning(); }
 
 void Continuation::jump(const Def* callee, Defs args, Debug dbg) {
     jump_debug_ = dbg;
+    if (auto target = fold_jump(callee, args, [] (const Def* def) { return def; }))
+        return jump(target, {}, dbg);
+
     if (auto continuation = callee->isa<Continuation>()) {
-        switch (continuation->intrinsic()) {
-            case Intrinsic::Branch: {
-                assert(args.size() == 3);
-                auto cond = args[0], t = args[1], f = args[2];
-                if (auto lit = cond->isa<PrimLit>())
-                    return jump(lit->value().get_bool() ? t : f, {}, dbg);
-                if (t == f)
-                    return jump(t, {}, dbg);
-                if (is_not(cond))
-                    return branch(cond->as<ArithOp>()->rhs(), f, t, dbg);
-                break;
-            }
-            case Intrinsic::Match:
-                if (args.size() == 2) return jump(args[1], {}, dbg);
-                if (auto lit = args[0]->isa<PrimLit>()) {
-                    for (size_t i = 2; i < args.size(); i++) {
-                        if (world().extract(args[i], 0_s)->as<PrimLit>() == lit)
-                            return jump(world().extract(args[i], 1), {}, dbg);
-                    }
-                    return jump(args[1], {}, dbg);
-                }
-                break;
-            default:
-                break;
+        if (continuation->intrinsic() == Intrinsic::Branch) {
+            auto cond = args[0], t = args[1], f = args[2];
+            if (t == f)
+                return jump(t, {}, dbg);
+            if (is_not(cond))
+                return branch(cond->as<ArithOp>()->rhs(), f, t, dbg);
         }
     }
 
@@ -338,4 +345,43 @@ bool is_passed_to_intrinsic(Continuation* cont, Intrinsic intrinsic, bool includ
     return visit_capturing_intrinsics(cont, [&] (Continuation* continuation) { return continuation->intrinsic() == intrinsic; }, include_globals);
 }
 
+const Def* fold_jump(const Def* callee, Defs args, std::function<const Def*(const Def*)> rewrite) {
+    auto continuation = callee->isa_continuation();
+    if (continuation == nullptr)
+        return nullptr;
+
+    switch (continuation->intrinsic()) {
+        case Intrinsic::Branch: {
+            assert(args.size() == 3);
+            if (auto lit = rewrite(args[0])->isa<PrimLit>())
+                return rewrite(lit->value().get_bool() ? args[1] : args[2]);
+            return nullptr;
+        }
+        case Intrinsic::Match: {
+            if (args.size() == 2)
+                return rewrite(args[1]);
+
+            auto lit = rewrite(args[0])->isa<PrimLit>();
+            if (lit == nullptr)
+                return nullptr;
+
+            for (size_t i = 2, e = args.size(); i != e; ++i) {
+                // look into the (pattern, continuation) pair directly - rewriting the whole pair would rewrite its target
+                auto arm = args[i]->isa<Tuple>();
+                if (arm == nullptr)
+                    return nullptr;
+                auto pattern = rewrite(arm->op(0))->isa<PrimLit>();
+                if (pattern == nullptr)
+                    return nullptr;
+                if (pattern == lit)
+                    return rewrite(arm->op(1));
+            }
+
+            return rewrite(args[1]);
+        }
+        default:
+            return nullptr;
+    }
+}
+
 }
@@ -149,7 +149,13 @@ public:
     bool is_returning() const;
     bool is_intrinsic() const;
     bool is_accelerator() const;
+    /// Is this @p Continuation neither external nor an intrinsic and only used as callee - so that we know all its calls?
+    bool has_known_calls() const;
     void destroy_body();
+    /// Marks this @p Continuation as modified in a new @p World::epoch.
+    void touch();
+    /// Has this @p Continuation - including the uses of it and its @p Param%s - been created or modified after @p epoch?
+    bool is_modified_since(size_t epoch) const { return epoch_ > epoch; }
 
     std::ostream& stream_head(std::ostream&) const;
     std::ostream& stream_jump(std::ostream&) const;
@@ -187,6 +193,7 @@ private:
     Array<const Def*> filter_; ///< used during @p partial_evaluation
     CC cc_;
     Intrinsic intrinsic_;
+    size_t epoch_ = 0;
 
     friend class Cleaner;
     friend class Scope;
@@ -199,6 +206,13 @@ bool visit_capturing_intrinsics(Continuation*, std::function<bool(Continuation*)
 bool is_passed_to_accelerator(Continuation*, bool include_globals = true);
 bool is_passed_to_intrinsic(Continuation*, Intrinsic, bool include_globals = true);
 
+/**
+ * Folds a jump to the @p Branch or @p Match intrinsic @p callee with @p args if its discriminant becomes a @p PrimLit after applying @p rewrite.
+ * Only the discriminant, the patterns and the taken target are passed through @p rewrite; all other targets are never touched.
+ * Returns the rewritten target or @c nullptr if the jump cannot be folded.
+ */
+const Def* fold_jump(const Def* callee, Defs args, std::function<const Def*(const Def*)> rewrite);
+
 struct Call {
     struct Hash {
         static uint64_t hash(const Call& call) { return call.hash(); }
@@ -34,6 +34,14 @@ Debug Def::debug_history() const {
 #endif
 }
 
+/// Changing the ops or uses of a @p Continuation or its @p Param%s modifies that @p Continuation.
+static void touch(const Def* def) {
+    if (auto continuation = def->isa_continuation())
+        continuation->touch();
+    else if (auto param = def->isa<Param>())
+        param->continuation()->touch();
+}
+
 void Def::set_op(size_t i, const Def* def) {
     assert(!op(i) && "already set");
     assert(def && "setting null pointer");
@@ -42,6 +50,8 @@ void Def::set_op(size_t i, const Def* def) {
     assert(!def->uses_.contains(Use(i, this)));
     const auto& p = def->uses_.emplace(i, this);
     assert_unused(p.second);
+    touch(this);
+    touch(def);
 }
 
 void Def::unregister_uses() const {
@@ -54,6 +64,8 @@ void Def::unregister_use(size_t i) const {
     assert(def->uses_.contains(Use(i, this)));
     def->uses_.erase(Use(i, this));
     assert(!def->uses_.contains(Use(i, this)));
+    touch(this);
+    touch(def);
 }
 
 void Def::unset_op(size_t i) {
@@ -141,6 +153,8 @@ void Def::replace(Tracker with) const {
             auto index = use.index();
             def->unset_op(index);
             def->set_op(index, with);
+            if (auto primop = def->isa<PrimOp>())
+                primop->is_outdated_ = true;
         }
 
         uses_.clear();
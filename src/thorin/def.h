@@ -69,6 +69,7 @@ private:
 //------------------------------------------------------------------------------
 
 struct UseHash {
+    static const HashStats::Category category = HashStats::Uses;
     inline static uint64_t hash(Use use);
     inline static bool eq(Use u1, Use u2) { return u1 == u2; }
     inline static Use sentinel() { return Use(size_t(-1), (const Def*)(-1)); }
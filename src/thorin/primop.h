@@ -31,6 +31,8 @@ public:
     const Def* rebuild(Defs ops) const { return rebuild(world(), ops, type()); }
     const Def* rebuild(Defs ops, const Type* type) const { return rebuild(world(), ops, type); }
     virtual bool has_multiple_outs() const { return false; }
+    /// Has one of the operands been @p replace%d in place? Then @p hash is stale and this @p PrimOp must be rebuilt.
+    bool is_outdated() const { return is_outdated_; }
     virtual const char* op_name() const;
     virtual std::ostream& stream(std::ostream&) const override;
     virtual std::ostream& stream_assignment(std::ostream&) const;
@@ -47,6 +49,7 @@ private:
     uint64_t hash() const { return hash_ == 0 ? hash_ = vhash() : hash_; }
 
     mutable uint64_t hash_ = 0;
+    mutable bool is_outdated_ = false;
 
     friend struct PrimOpHash;
     friend class World;
@@ -55,6 +58,7 @@ private:
 };
 
 struct PrimOpHash {
+    static const HashStats::Category category = HashStats::PrimOps;
     static uint64_t hash(const PrimOp* o) { return o->hash(); }
     static bool eq(const PrimOp* o1, const PrimOp* o2) { return o1->equal(o2); }
     static const PrimOp* sentinel() { return (const PrimOp*)(1); }
@@ -0,0 +1,125 @@
+#include "thorin/primop.h"
+#include "thorin/world.h"
+#include "thorin/transform/aos_to_soa.h"
+#include "thorin/util/log.h"
+
+namespace thorin {
+
+/// Returns the element type of @p type if it is an array of structs or tuples with at least two fields.
+static const Type* aggregate_elem_type(const Type* type) {
+    auto array_type = type->isa<ArrayType>();
+    if (array_type == nullptr)
+        return nullptr;
+    auto elem_type = array_type->elem_type();
+    if ((!elem_type->isa<StructType>() && !elem_type->isa<TupleType>()) || elem_type->num_ops() < 2)
+        return nullptr;
+    return elem_type;
+}
+
+/// Is @p elem_ptr - a pointer to an array element - only used to access the whole element or its fields?
+static bool is_field_access(const Def* elem_ptr) {
+    for (auto use : elem_ptr->uses()) {
+        if (auto lea = use->isa<LEA>()) {
+            if (use.index() != 0 || !lea->index()->isa<PrimLit>())
+                return false;
+        } else if (!use->isa<Load>() && !(use->isa<Store>() && use.index() == 1)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/// Is @p ptr only indexed and are all elements only accessed as a whole or field-wise?
+static bool can_split(const Def* ptr) {
+    for (auto use : ptr->uses()) {
+        auto lea = use->isa<LEA>();
+        if (lea == nullptr || use.index() != 0 || !is_field_access(lea))
+            return false;
+    }
+    return true;
+}
+
+static void split(const Alloc* alloc, const Def* ptr) {
+    auto& world = alloc->world();
+    auto array_type = alloc->alloced_type()->as<ArrayType>();
+    auto elem_type = array_type->elem_type();
+    auto dim = elem_type->num_ops();
+
+    // one array per field - allocated one after the other
+    Array<const Def*> field_ptrs(dim);
+    const Def* mem = alloc->mem();
+    for (size_t i = 0; i != dim; ++i) {
+        auto field_type = elem_type->op(i);
+        const Type* type = world.indefinite_array_type(field_type);
+        if (auto definite_array_type = array_type->isa<DefiniteArrayType>())
+            type = world.definite_array_type(field_type, definite_array_type->dim());
+        auto field_alloc = world.alloc(type, mem, alloc->extra(), alloc->debug());
+        mem = world.extract(field_alloc, 0_u32, alloc->debug());
+        field_ptrs[i] = world.extract(field_alloc, 1_u32, alloc->debug());
+    }
+
+    for (auto use : ptr->copy_uses()) {
+        auto elem_ptr = use->as<LEA>();
+        auto index = elem_ptr->index();
+        auto field_ptr = [&] (size_t i) { return world.lea(field_ptrs[i], index, elem_ptr->debug()); };
+
+        for (auto elem_use : elem_ptr->copy_uses()) {
+            if (auto lea = elem_use->isa<LEA>()) {
+                lea->replace(field_ptr(primlit_value<u64>(lea->index())));
+            } else if (auto load = elem_use->isa<Load>()) {
+                Array<const Def*> fields(dim);
+                const Def* in_mem = load->mem();
+                for (size_t i = 0; i != dim; ++i) {
+                    auto tuple = world.load(in_mem, field_ptr(i), load->debug());
+                    in_mem = world.extract(tuple, 0_u32, load->debug());
+                    fields[i] = world.extract(tuple, 1_u32, load->debug());
+                }
+                auto val = elem_type->isa<StructType>()
+                         ? world.struct_agg(elem_type->as<StructType>(), fields, load->debug())
+                         : world.tuple(fields, load->debug());
+                load->replace(world.tuple({ in_mem, val }, load->debug()));
+            } else {
+                auto store = elem_use->as<Store>();
+                const Def* in_mem = store->mem();
+                for (size_t i = 0; i != dim; ++i)
+                    in_mem = world.store(in_mem, field_ptr(i), world.extract(store->val(), i, store->debug()), store->debug());
+                store->replace(in_mem);
+            }
+        }
+    }
+
+    alloc->replace(world.tuple({ mem, world.bottom(ptr->type(), alloc->debug()) }, alloc->debug()));
+}
+
+void aos_to_soa(World& world) {
+    std::vector<std::pair<const Alloc*, const Def*>> candidates;
+    for (auto primop : world.primops()) {
+        if (auto alloc = primop->isa<Alloc>()) {
+            if (alloc->is_replaced() || aggregate_elem_type(alloc->alloced_type()) == nullptr)
+                continue;
+
+            const Def* ptr = nullptr;
+            bool escapes = false;
+            for (auto use : alloc->uses()) {
+                if (Alloc::is_out_ptr(use))
+                    ptr = use;
+                else if (!Alloc::is_out_mem(use))
+                    escapes = true;
+            }
+
+            if (!escapes && ptr != nullptr && can_split(ptr))
+                candidates.emplace_back(alloc, ptr);
+        }
+    }
+
+    for (const auto& p : candidates) {
+        DLOG("splitting {} into one array per field", p.first);
+        split(p.first, p.second);
+    }
+
+    VLOG("split {} arrays of structs", candidates.size());
+    if (!candidates.empty())
+        world.cleanup();
+}
+
+}
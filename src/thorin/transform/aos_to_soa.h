@@ -0,0 +1,19 @@
+#ifndef THORIN_TRANSFORM_AOS_TO_SOA_H
+#define THORIN_TRANSFORM_AOS_TO_SOA_H
+
+namespace thorin {
+
+class World;
+
+/**
+ * Array-of-structs to struct-of-arrays layout transformation.
+ * An @p Alloc of an array of structs or tuples whose pointer is only used to access elements and their fields is replaced
+ * by one @p Alloc per field; all @p LEA%s, @p Load%s and @p Store%s are rewritten accordingly.
+ * This must run before @p lift_builtins: buffers captured by kernels of @p Intrinsic::Parallel, @p Intrinsic::Vectorize
+ * or GPU intrinsics are rewritten along with the rest of the program as long as they are still free variables.
+ */
+void aos_to_soa(World&);
+
+}
+
+#endif
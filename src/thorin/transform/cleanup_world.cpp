@@ -1,3 +1,5 @@
+#include <algorithm>
+
 #include "thorin/config.h"
 #include "thorin/world.h"
 #include "thorin/analyses/cfg.h"
@@ -5,11 +7,12 @@
 #include "thorin/analyses/domtree.h"
 #include "thorin/analyses/scope.h"
 #include "thorin/analyses/verify.h"
-#include "thorin/transform/importer.h"
 #include "thorin/transform/mangle.h"
 #include "thorin/transform/resolve_loads.h"
 #include "thorin/transform/partial_evaluation.h"
 #include "thorin/util/log.h"
+#include "thorin/util/pass_report.h"
+#include "thorin/util/trace.h"
 
 namespace thorin {
 
@@ -24,20 +27,35 @@ public:
     void eliminate_tail_rec();
     void eta_conversion();
     void eliminate_params();
-    void rebuild();
+    void collect();
     void verify_closedness();
     void within(const Def*);
     void clean_pe_infos();
 
 private:
     void cleanup_fix_point();
+    std::vector<Continuation*> modified_since(size_t epoch);
     void clean_pe_info(std::queue<Continuation*>, Continuation*);
+    const Def* mark(Tracker);
     World& world_;
+    DefSet live_;
+    TypeSet live_types_;
+    Continuation* marking_ = nullptr; ///< the @p Continuation whose ops are currently marked
+    size_t epoch_ = 0;                ///< sub-passes only look at @p Continuation%s modified after this @p World::epoch
+    ScopeCache scopes_;
     bool todo_ = true;
 };
 
+/// The @p Continuation%s modified after @p epoch - all of them if the @p World hasn't recorded that far back.
+std::vector<Continuation*> Cleaner::modified_since(size_t epoch) {
+    if (world().is_recorded_since(epoch))
+        return world().modified_since(epoch);
+    auto continuations = world().copy_continuations();
+    return std::vector<Continuation*>(continuations.begin(), continuations.end());
+}
+
 void Cleaner::eliminate_tail_rec() {
-    Scope::for_each(world_, [&](Scope& scope) {
+    Scope::for_each(world_, scopes_, epoch_, [&](Scope& scope) {
         auto entry = scope.entry();
 
         bool only_tail_calls = true;
@@ -96,10 +114,36 @@ void Cleaner::eliminate_tail_rec() {
 }
 
 void Cleaner::eta_conversion() {
+    // a callee is also modified if its uses change
+    auto is_modified_since = [&](Continuation* continuation, size_t epoch) {
+        if (continuation->is_modified_since(epoch))
+            return true;
+        auto callee = continuation->callee()->isa_continuation();
+        return callee && callee->is_modified_since(epoch);
+    };
+
+    // the modified continuations and their callers
+    auto modified_or_callers = [&](size_t epoch) {
+        ContinuationSet done;
+        std::vector<Continuation*> result;
+        for (auto continuation : modified_since(epoch)) {
+            if (done.emplace(continuation).second)
+                result.push_back(continuation);
+            for (auto use : continuation->uses()) {
+                auto caller = use->isa_continuation();
+                if (caller && use.index() == 0 && done.emplace(caller).second)
+                    result.push_back(caller);
+            }
+        }
+        return result;
+    };
+
+    auto epoch = epoch_;
     for (bool todo = true; todo;) {
         todo = false;
-        for (auto continuation : world().continuations()) {
-            if (!continuation->empty()) {
+        auto next_epoch = world().epoch();
+        for (auto continuation : modified_or_callers(epoch)) {
+            if (!continuation->empty() && is_modified_since(continuation, epoch)) {
                 // eat calls to known continuations that are only used once
                 while (auto callee = continuation->callee()->isa_continuation()) {
                     if (callee->num_uses() == 1 && !callee->empty() && !callee->is_external()) {
@@ -159,15 +203,16 @@ void Cleaner::eta_conversion() {
                 }
             }
         }
+        epoch = next_epoch;
     }
 }
 
 void Cleaner::eliminate_params() {
-    for (auto ocontinuation : world().copy_continuations()) {
+    for (auto ocontinuation : modified_since(epoch_)) {
         std::vector<size_t> proxy_idx;
         std::vector<size_t> param_idx;
 
-        if (!ocontinuation->empty() && !world().is_external(ocontinuation)) {
+        if (!ocontinuation->empty() && !world().is_external(ocontinuation) && ocontinuation->is_modified_since(epoch_)) {
             for (auto use : ocontinuation->uses()) {
                 if (use.index() != 0 || !use->isa_continuation())
                     goto next_continuation;
@@ -208,20 +253,143 @@ next_continuation:;
     }
 }
 
-void Cleaner::rebuild() {
-    Importer importer(world_);
-    importer.type_old2new_.rehash(world_.types_.capacity());
-    importer.def_old2new_.rehash(world_.primops().capacity());
+/**
+ * Collects garbage in place:
+ * Marks everything reachable from the externals, rebuilds the @p PrimOp%s whose operands have been replaced, and
+ * deletes all unreachable @p PrimOp%s, @p Continuation%s and @p Type%s.
+ */
+void Cleaner::collect() {
+    // live primops are hash-consed again into a fresh table - this resolves replaced operands and stale hashes
+    World::PrimOpSet old_primops(world_.primops().capacity());
+    swap(old_primops, world_.primops_);
+    live_.clear();
+    live_types_.clear();
+
+    mark(world_.branch());
+    mark(world_.end_scope());
+    for (auto external : world().externals())
+        mark(external);
 
-#if THORIN_ENABLE_CHECKS
-    world_.swap_breakpoints(importer.world());
-#endif
+    // rebuilding may have produced intermediate primops that are not used at all
+    std::vector<const PrimOp*> dead_primops;
+    for (auto primop : world_.primops()) {
+        if (!live_.contains(primop))
+            dead_primops.emplace_back(primop);
+    }
+    for (auto primop : dead_primops)
+        world_.primops_.erase(primop);
+    for (auto primop : old_primops) {
+        if (!live_.contains(primop))
+            dead_primops.emplace_back(primop);
+    }
 
-    for (auto external : world().externals())
-        importer.import(external);
+    std::vector<Continuation*> dead_continuations;
+    for (auto continuation : world_.continuations()) {
+        if (!live_.contains(continuation))
+            dead_continuations.emplace_back(continuation);
+    }
+    for (auto continuation : dead_continuations)
+        world_.continuations_.erase(continuation);
+
+    // first unregister all uses of dead defs - they may point to each other - then delete them
+    for (auto primop : dead_primops)
+        primop->unregister_uses();
+    for (auto continuation : dead_continuations)
+        continuation->destroy_body();
+
+    // destroying the bodies has touched the dead continuations - forget them and all modifications the sub-passes
+    // won't ask for anymore
+    ContinuationSet dead(dead_continuations.begin(), dead_continuations.end());
+    scopes_.forget(dead);
+    if (world_.recorded_since_ != size_t(-1)) {
+        auto& modified = world_.modified_;
+        modified.erase(std::remove_if(modified.begin(), modified.end(), [&](const std::pair<size_t, Continuation*>& p) {
+            return p.first <= epoch_ || dead.contains(p.second);
+        }), modified.end());
+        world_.recorded_since_ = std::max(world_.recorded_since_, epoch_);
+    }
+
+    DLOG("collected {} primops and {} continuations", dead_primops.size(), dead_continuations.size());
+    for (auto primop : dead_primops) {
+        assert(primop->uses().empty());
+        delete primop;
+    }
+    for (auto continuation : dead_continuations)
+        delete continuation;
+
+    world_.sweep(std::move(live_types_));
+}
+
+const Def* Cleaner::mark(Tracker tracker) {
+    auto def = tracker.def();
+    if (live_.contains(def))
+        return def;
+
+    live_types_.insert(def->type());
+
+    if (auto param = def->isa<Param>()) {
+        mark(param->continuation());
+        return param;
+    }
+
+    if (auto continuation = def->isa_continuation()) {
+        auto marking = marking_;
+        marking_ = continuation;
+        live_.insert(continuation);
+        for (auto param : continuation->params()) {
+            live_.insert(param);
+            live_types_.insert(param->type());
+        }
+
+        if (!continuation->empty()) {
+            if (auto target = fold_jump(continuation->callee(), continuation->args(), [&] (const Def* def) { return mark(def); })) {
+                continuation->jump(target, {}, continuation->jump_debug());
+            } else {
+                for (size_t i = 0, e = continuation->num_ops(); i != e; ++i)
+                    mark(continuation->op(i));
+            }
+        }
+
+        // the filter doesn't register uses and may thus still point to replaced defs
+        if (!continuation->filter().empty()) {
+            Array<const Def*> filter(continuation->filter().size());
+            for (size_t i = 0, e = filter.size(); i != e; ++i)
+                filter[i] = mark(continuation->filter(i));
+            continuation->set_filter(filter);
+        }
+
+        marking_ = marking;
+        return continuation;
+    }
+
+    auto primop = def->as<PrimOp>();
+    for (size_t i = 0, e = primop->num_ops(); i != e; ++i)
+        mark(primop->op(i));
+
+    // a cycle through a continuation - e.g. a Global or Closure used in its own body - may have handled primop already
+    if (live_.contains(primop))
+        return primop;
+    if (primop->is_replaced())
+        return mark(primop);
+
+    const Def* ndef;
+    if (primop->is_outdated()) {
+        ndef = primop->rebuild(primop->ops());
+        todo_ |= ndef->tag() != primop->tag();
+    } else {
+        ndef = *world_.primops_.insert(primop).first;
+    }
+
+    if (ndef != primop) {
+        // primops don't belong to a continuation - so at least touch the one that led us here
+        if (marking_ != nullptr)
+            marking_->touch();
+        primop->replace(ndef);
+        return mark(ndef);
+    }
 
-    swap(importer.world(), world_);
-    todo_ |= importer.todo();
+    live_.insert(primop);
+    return primop;
 }
 
 void Cleaner::verify_closedness() {
@@ -301,23 +469,30 @@ void Cleaner::cleanup_fix_point() {
     int i = 0;
     for (; todo_; ++i) {
         VLOG("iteration: {}", i);
+        PassReport::Measure measure(world(), "cleanup iteration " + std::to_string(i));
+        Trace::Span span("pass");
+        if (span)
+            span.name("cleanup iteration " + std::to_string(i));
         todo_ = false;
+        auto epoch = world().epoch();
         if (world_.is_pe_done())
             eliminate_tail_rec();
         eta_conversion();
         eliminate_params();
-        rebuild(); // resolve replaced defs before going to resolve_loads
-        todo_ |= resolve_loads(world());
-        rebuild();
+        collect(); // resolve replaced defs before going to resolve_loads
+        todo_ |= resolve_loads(world(), scopes_, epoch_);
+        collect();
         if (!world().is_pe_done())
             todo_ |= partial_evaluation(world_);
         else
             clean_pe_infos();
+        epoch_ = epoch;
     }
 }
 
 void Cleaner::cleanup() {
     VLOG("start cleanup");
+    world().record_modified();
     cleanup_fix_point();
 
     if (!world().is_pe_done()) {
@@ -325,9 +500,11 @@ void Cleaner::cleanup() {
         for (auto continuation : world().continuations())
             continuation->destroy_filter();
         todo_ = true;
+        epoch_ = 0; // eliminate_tail_rec hasn't seen anything yet
         cleanup_fix_point();
     }
 
+    world().record_modified(false);
     VLOG("end cleanup");
 #if THORIN_ENABLE_CHECKS
     verify_closedness();
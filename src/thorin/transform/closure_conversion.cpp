@@ -33,8 +33,12 @@ public:
 
                 new_defs_[continuation] = new_continuation;
                 if (!continuation->empty()) {
-                    for (size_t i = 0, e = continuation->num_params(); i != e; ++i)
+                    for (size_t i = 0, e = continuation->num_params(); i != e; ++i) {
                         new_defs_[continuation->param(i)] = new_continuation->param(i);
+                        // primops are only rebuilt by convert if they are higher-order
+                        if (continuation->param(i)->type() == new_continuation->param(i)->type())
+                            continuation->param(i)->replace(new_continuation->param(i));
+                    }
                     // copy existing call from old continuation
                     new_continuation->jump(continuation->callee(), continuation->args(), continuation->jump_debug());
                     converted.emplace_back(continuation, new_continuation);
@@ -0,0 +1,114 @@
+#include "thorin/primop.h"
+#include "thorin/world.h"
+#include "thorin/analyses/alias.h"
+#include "thorin/analyses/scope.h"
+#include "thorin/transform/dead_store_opt.h"
+#include "thorin/util/log.h"
+
+namespace thorin {
+
+class DeadStoreOpt {
+public:
+    /// Gives up if more than this many mem uses have to be inspected for a single @p Store.
+    static const size_t max_steps = 1024;
+
+    DeadStoreOpt(const Scope& scope)
+        : scope_(scope)
+    {}
+
+    size_t run() {
+        std::vector<const Store*> dead;
+        for (auto def : scope_.defs()) {
+            if (auto store = def->isa<Store>()) {
+                if (is_dead_store(store))
+                    dead.push_back(store);
+            }
+        }
+
+        // a store is dead if its value is never read - removing other dead stores doesn't change that
+        for (auto store : dead)
+            store->replace(store->mem());
+        return dead.size();
+    }
+
+private:
+    /// Is the value of @p store overwritten or discarded on all paths before it may be read?
+    bool is_dead_store(const Store* store) {
+        ptr_ = store->ptr();
+        local_ = is_local(base_object(ptr_));
+        visited_.clear();
+        steps_ = 0;
+        return is_dead_mem(store);
+    }
+
+    bool is_dead_mem(const Def* mem) {
+        if (!visited_.emplace(mem).second)
+            return true; // back at a mem we already inspected - no read on this cycle
+        for (auto use : mem->uses()) {
+            if (++steps_ > max_steps || !is_dead_use(use))
+                return false;
+        }
+        return true;
+    }
+
+    bool is_dead_use(Use use) {
+        if (auto continuation = use->isa_continuation())
+            return use.index() != 0 && is_dead_arg(continuation, use.index() - 1);
+
+        if (use.index() != 0)
+            return false;
+
+        if (auto store = use->isa<Store>())
+            return store->ptr() == ptr_ || is_dead_mem(store);
+        if (auto load = use->isa<Load>())
+            return !may_alias(load->ptr(), ptr_) && is_dead_mem(load->out_mem());
+        if (auto enter = use->isa<Enter>())
+            return is_dead_mem(enter->out_mem());
+        if (auto alloc = use->isa<Alloc>())
+            return is_dead_mem(alloc->out_mem());
+        if (auto memop = use->isa<MemOp>())
+            return local_ && is_dead_mem(memop->out_mem());
+
+        return false; // mem ends up in some aggregate - we don't know what happens to it
+    }
+
+    /// @p continuation passes the mem as its @p i-th argument.
+    bool is_dead_arg(Continuation* continuation, size_t i) {
+        auto callee = continuation->callee()->isa_continuation();
+        if (callee != nullptr && scope_.contains(callee) && !callee->empty()) {
+            if (!is_dead_mem(callee->param(i)))
+                return false;
+        } else if (!local_) {
+            // all other callees - functions, intrinsics, the return continuation - may read a non-local object
+            return false;
+        }
+
+        // continuations of this scope passed along - e.g. the return continuation of a recursive call - run later on;
+        // a local object is only accessible within this scope again - and dies when we leave it
+        for (auto arg : continuation->args()) {
+            if (auto target = arg->isa_continuation()) {
+                if (!scope_.contains(target))
+                    continue;
+                for (auto param : target->params()) {
+                    if (param->type()->isa<MemType>() && !is_dead_mem(param))
+                        return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    const Scope& scope_;
+    const Def* ptr_ = nullptr;
+    bool local_ = false;
+    DefSet visited_;
+    size_t steps_ = 0;
+};
+
+void dead_store_opt(World& world) {
+    size_t num_removed = 0;
+    Scope::for_each(world, [&] (const Scope& scope) { num_removed += DeadStoreOpt(scope).run(); });
+    VLOG("removed {} dead stores", num_removed);
+}
+
+}
@@ -0,0 +1,17 @@
+#ifndef THORIN_TRANSFORM_DEAD_STORE_OPT_H
+#define THORIN_TRANSFORM_DEAD_STORE_OPT_H
+
+namespace thorin {
+
+class World;
+
+/**
+ * Removes @p Store%s whose value is never read:
+ * On all paths along the mem chain the pointer is either overwritten by another @p Store or the pointer refers to a local
+ * @p Slot or @p Alloc that dies without being read again.
+ */
+void dead_store_opt(World&);
+
+}
+
+#endif
@@ -0,0 +1,237 @@
+#include "thorin/continuation.h"
+#include "thorin/primop.h"
+#include "thorin/world.h"
+#include "thorin/transform/defunctionalize.h"
+#include "thorin/util/log.h"
+
+namespace thorin {
+
+class Defunctionalizer {
+public:
+    /// Only dispatch to this many different functions through a single tag.
+    static const size_t max_callees = 4;
+    /// Only pass this many environment values instead of a single closure.
+    static const size_t max_env = 16;
+
+    Defunctionalizer(World& world)
+        : world_(world)
+    {}
+
+    World& world() const { return world_; }
+
+    size_t run() {
+        size_t num = 0;
+        bool todo = true;
+        while (todo) {
+            todo = false;
+            for (auto continuation : world().copy_continuations()) {
+                if (!is_candidate(continuation))
+                    continue;
+                for (auto param : continuation->params()) {
+                    if (param->type()->isa<ClosureType>() && defunctionalize(param)) {
+                        ++num;
+                        todo = true;
+                        break; // continuation has been replaced
+                    }
+                }
+            }
+        }
+        return num;
+    }
+
+private:
+    /// The function a @p Closure calls - its wrapper merely unpacks the environment and calls the lifted continuation.
+    struct Callee {
+        Continuation* wrapper;
+        Continuation* lifted;
+        size_t num_params; ///< number of params without the environment
+        size_t num_free;   ///< number of free variables in the environment
+    };
+
+    /// Do we know all calls of @p continuation?
+    static bool is_candidate(Continuation* continuation) { return !continuation->empty() && continuation->has_known_calls(); }
+
+    /// See @p ClosureConversion - returns @c false if @p closure has a different shape.
+    static bool callee(const Closure* closure, Callee& callee) {
+        auto wrapper = closure->op(0)->isa_continuation();
+        if (wrapper == nullptr || wrapper->empty() || wrapper->num_params() == 0)
+            return false;
+        auto lifted = wrapper->callee()->isa_continuation();
+        if (lifted == nullptr || lifted->empty() || lifted->num_params() + 1 < wrapper->num_params())
+            return false;
+
+        callee.wrapper    = wrapper;
+        callee.lifted     = lifted;
+        callee.num_params = wrapper->num_params() - 1;
+        callee.num_free   = lifted->num_params() - callee.num_params;
+        return true;
+    }
+
+    /// The @p i-th free variable stored in the environment of @p closure.
+    const Def* free_var(const Closure* closure, const Callee& callee, size_t i) {
+        auto env = closure->op(1);
+        return callee.num_free == 1 ? env : world().extract(env, i, closure->debug());
+    }
+
+    /**
+     * Replaces the closure @p param by a tag that selects the callee and the free variables of all possible callees.
+     * This requires that @p param is only called or passed along to the same param again and that all other values
+     * of @p param are known @p Closure%s.
+     */
+    bool defunctionalize(const Param* param) {
+        auto ocontinuation = param->continuation();
+        auto index = param->index();
+
+        std::vector<Continuation*> calls;
+        for (auto use : param->uses()) {
+            auto continuation = use->isa_continuation();
+            if (continuation == nullptr)
+                return false;
+            if (use.index() == 0)
+                calls.push_back(continuation);
+            else if (continuation->callee() != ocontinuation || use.index() != index + 1)
+                return false;
+        }
+
+        std::vector<Callee> callees;
+        size_t num_env = 0;
+        for (auto use : ocontinuation->uses()) {
+            auto arg = use->as_continuation()->arg(index);
+            if (arg == param)
+                continue;
+            auto closure = arg->isa<Closure>();
+            Callee cur;
+            if (closure == nullptr || !callee(closure, cur))
+                return false;
+            if (group(callees, closure) == callees.size()) {
+                callees.push_back(cur);
+                num_env += cur.num_free;
+            }
+        }
+
+        if (callees.empty() || callees.size() > max_callees || num_env > max_env)
+            return false;
+
+        DLOG("defunctionalizing {} with {} callees", param, callees.size());
+
+        // new param list: the tag - if there is a choice - and the free variables of all callees replace the closure
+        bool tagged = callees.size() != 1;
+        std::vector<const Type*> types;
+        for (size_t i = 0, e = ocontinuation->num_params(); i != e; ++i) {
+            if (i == index) {
+                if (tagged)
+                    types.push_back(world().type_qu32());
+                for (const auto& callee : callees) {
+                    for (size_t j = 0; j != callee.num_free; ++j)
+                        types.push_back(callee.lifted->param(callee.num_params + j)->type());
+                }
+            } else {
+                types.push_back(ocontinuation->param(i)->type());
+            }
+        }
+
+        auto ncontinuation = world().continuation(world().fn_type(types), ocontinuation->cc(), ocontinuation->intrinsic(), ocontinuation->debug_history());
+        size_t num_new = types.size() - ocontinuation->num_params() + 1;
+        Array<const Def*> new_params(num_new);
+        for (size_t i = 0; i != num_new; ++i) {
+            new_params[i] = ncontinuation->param(index + i);
+            new_params[i]->debug().set(param->name() + (tagged && i == 0 ? "_tag" : "_env"));
+        }
+
+        for (auto call : calls)
+            dispatch(call, callees, new_params);
+
+        for (size_t i = 0, j = 0, e = ocontinuation->num_params(); i != e; ++i) {
+            if (i == index) {
+                j += num_new;
+            } else {
+                ocontinuation->param(i)->replace(ncontinuation->param(j));
+                ncontinuation->param(j++)->debug() = ocontinuation->param(i)->debug_history();
+            }
+        }
+
+        if (!ocontinuation->filter().empty()) {
+            Array<const Def*> filter(types.size());
+            for (size_t i = 0, j = 0, e = ocontinuation->num_params(); i != e; ++i) {
+                for (size_t k = 0, n = i == index ? num_new : 1; k != n; ++k)
+                    filter[j++] = ocontinuation->filter(i);
+            }
+            ncontinuation->set_filter(filter);
+        }
+        ncontinuation->jump(ocontinuation->callee(), ocontinuation->args(), ocontinuation->jump_debug());
+        ocontinuation->destroy_body();
+
+        for (auto use : ocontinuation->copy_uses()) {
+            auto caller = use->as_continuation();
+            Array<const Def*> args(types.size());
+            for (size_t i = 0, j = 0, e = caller->num_args(); i != e; ++i) {
+                if (i != index) {
+                    args[j++] = caller->arg(i);
+                } else if (caller->arg(i) == param) {
+                    for (auto new_param : new_params)
+                        args[j++] = new_param;
+                } else {
+                    auto closure = caller->arg(i)->as<Closure>();
+                    auto tag = group(callees, closure);
+                    if (tagged)
+                        args[j++] = world().literal_qu32(tag, closure->debug());
+                    for (size_t k = 0, e = callees.size(); k != e; ++k) {
+                        const auto& callee = callees[k];
+                        for (size_t l = 0; l != callee.num_free; ++l) {
+                            auto type = callee.lifted->param(callee.num_params + l)->type();
+                            args[j++] = k == tag ? free_var(closure, callee, l) : world().bottom(type, closure->debug());
+                        }
+                    }
+                }
+            }
+            caller->jump(ncontinuation, args, caller->jump_debug());
+        }
+
+        return true;
+    }
+
+    /// Index of the group of @p callees that @p closure belongs to - @c callees.size() if none.
+    static size_t group(const std::vector<Callee>& callees, const Closure* closure) {
+        for (size_t i = 0, e = callees.size(); i != e; ++i) {
+            if (callees[i].wrapper == closure->op(0))
+                return i;
+        }
+        return callees.size();
+    }
+
+    /// Replaces the indirect call in @p call by direct calls of the lifted continuations - selected by a @p match on the tag.
+    void dispatch(Continuation* call, const std::vector<Callee>& callees, Defs new_params) {
+        bool tagged = callees.size() != 1;
+        Array<Continuation*> cases(callees.size());
+        for (size_t k = 0, env = tagged ? 1 : 0, e = callees.size(); k != e; ++k) {
+            const auto& callee = callees[k];
+            Array<const Def*> args(callee.num_params + callee.num_free);
+            for (size_t i = 0; i != callee.num_params; ++i)
+                args[i] = call->arg(i);
+            for (size_t i = 0; i != callee.num_free; ++i)
+                args[callee.num_params + i] = new_params[env++];
+
+            if (!tagged) {
+                call->jump(callee.lifted, args, call->jump_debug());
+                return;
+            }
+
+            cases[k] = world().continuation(world().fn_type(), Debug(callee.lifted->name() + "_case"));
+            cases[k]->jump(callee.lifted, args, call->jump_debug());
+        }
+
+        Array<const Def*> patterns(callees.size() - 1);
+        for (size_t k = 0, e = patterns.size(); k != e; ++k)
+            patterns[k] = world().literal_qu32(k, call->jump_debug());
+        call->match(new_params.front(), cases.back(), patterns, cases.skip_back(), call->jump_debug());
+    }
+
+    World& world_;
+};
+
+void defunctionalize(World& world) {
+    auto num = Defunctionalizer(world).run();
+    VLOG("defunctionalized {} closure params", num);
+}
+
+}
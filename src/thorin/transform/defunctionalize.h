@@ -0,0 +1,19 @@
+#ifndef THORIN_TRANSFORM_DEFUNCTIONALIZE_H
+#define THORIN_TRANSFORM_DEFUNCTIONALIZE_H
+
+namespace thorin {
+
+class World;
+
+/**
+ * Escape analysis for @p Closure%s created by @p closure_conversion.
+ * A closure param of a @p Continuation whose calls are all known and that only receives a few known @p Closure%s is
+ * replaced by a tag and the free variables of these closures.
+ * Calls through the param become direct calls of the lifted continuations - selected by a @p match on the tag.
+ * The environments of these closures are passed in registers and need not be allocated anymore.
+ */
+void defunctionalize(World&);
+
+}
+
+#endif
@@ -0,0 +1,184 @@
+#include "thorin/primop.h"
+#include "thorin/world.h"
+#include "thorin/analyses/alias.h"
+#include "thorin/analyses/cfg.h"
+#include "thorin/analyses/scope.h"
+#include "thorin/transform/forward_loads.h"
+#include "thorin/util/log.h"
+
+namespace thorin {
+
+class ForwardLoads {
+public:
+    /// Maps pointers to the values they are known to point to.
+    typedef Def2Def Values;
+
+    ForwardLoads(const Scope& scope)
+        : scope_(scope)
+        , cfg_(scope.f_cfg())
+    {}
+
+    World& world() const { return scope_.world(); }
+
+    size_t run() {
+        for (auto n : cfg_.reverse_post_order()) {
+            auto continuation = n->continuation();
+            for (auto param : continuation->params()) {
+                if (param->type()->isa<MemType>())
+                    forward(param, incoming(n, param->index()));
+            }
+        }
+        return num_forwarded_;
+    }
+
+private:
+    /// Merges the @p Values of all predecessors - unless one of them hasn't been visited yet.
+    Values incoming(const CFNode* n, size_t i) {
+        auto continuation = n->continuation();
+        if (n == cfg_.entry())
+            return Values();
+
+        // we only know all predecessors if the continuation is merely called within this scope
+        for (auto use : continuation->uses()) {
+            if (!use->isa_continuation() || !scope_.contains(use))
+                return Values();
+        }
+
+        Values result;
+        bool first = true;
+        for (auto pred : cfg_.preds(n)) {
+            auto pred_continuation = pred->continuation();
+            const Def* mem = nullptr;
+            bool call = pred_continuation->callee() != continuation;
+            if (call) {
+                for (auto arg : pred_continuation->args()) {
+                    if (is_mem(arg)) {
+                        mem = arg;
+                        break;
+                    }
+                }
+            } else {
+                mem = pred_continuation->arg(i);
+            }
+
+            auto state = mem != nullptr ? states_.find(mem) : states_.end();
+            if (state == states_.end())
+                return Values(); // back edge or mem we don't know anything about
+
+            const auto& values = state->second;
+            if (first) {
+                result = call ? clobber(values) : values;
+                first = false;
+            } else {
+                result = intersect(result, call ? clobber(values) : values);
+            }
+        }
+
+        return result;
+    }
+
+    /// Traverses the tree of memory objects starting at @p mem.
+    void forward(const Def* mem, Values values) {
+        while (mem) {
+            auto uses = mem->copy_uses();
+            for (auto use : uses) {
+                if (use->isa_continuation()) {
+                    states_.emplace(mem, values);
+                    break;
+                }
+            }
+
+            const Def* next = nullptr;
+            size_t i = 0, n = uses.size();
+            for (auto it = uses.begin(); i != n; ++i, ++it) {
+                if (i == n - 1) {
+                    next = process(*it, values);
+                } else {
+                    Values split_values = values;
+                    if (auto next_mem = process(*it, split_values))
+                        forward(next_mem, split_values);
+                }
+            }
+            mem = next;
+        }
+    }
+
+    const Def* process(Use use, Values& values) {
+        if (use.index() != 0)
+            return nullptr;
+
+        if (auto load = use->isa<Load>()) {
+            // fetch the out mem before the load is replaced - otherwise the traversal would stop here
+            auto out_mem = load->out_mem();
+            if (auto value = find(values, load->ptr())) {
+                load->replace(world().tuple({ load->mem(), value }, load->debug()));
+                ++num_forwarded_;
+            } else {
+                values[load->ptr()] = load->out_val();
+            }
+            return out_mem;
+        } else if (auto store = use->isa<Store>()) {
+            values = kill(values, store->ptr());
+            values[store->ptr()] = store->val();
+            return store;
+        } else if (auto enter = use->isa<Enter>()) {
+            return enter->out_mem();
+        } else if (auto alloc = use->isa<Alloc>()) {
+            return alloc->out_mem();
+        } else if (auto memop = use->isa<MemOp>()) {
+            // may access anything that is not local
+            values = clobber(values);
+            return memop->out_mem();
+        }
+
+        return nullptr;
+    }
+
+    Values kill(const Values& values, const Def* ptr) {
+        Values result;
+        for (const auto& p : values) {
+            if (!may_alias(p.first, ptr))
+                result.emplace(p.first, p.second);
+        }
+        return result;
+    }
+
+    Values clobber(const Values& values) {
+        Values result;
+        for (const auto& p : values) {
+            if (is_local_object(base_object(p.first)))
+                result.emplace(p.first, p.second);
+        }
+        return result;
+    }
+
+    bool is_local_object(const Def* object) {
+        auto i = local_.find(object);
+        if (i != local_.end())
+            return i->second;
+        return local_[object] = is_local(object);
+    }
+
+    static Values intersect(const Values& a, const Values& b) {
+        Values result;
+        for (const auto& p : a) {
+            if (find(b, p.first) == p.second)
+                result.emplace(p.first, p.second);
+        }
+        return result;
+    }
+
+    const Scope& scope_;
+    const F_CFG& cfg_;
+    DefMap<Values> states_; ///< @p Values at @p mem%s passed to other @p Continuation%s
+    DefMap<bool> local_;
+    size_t num_forwarded_ = 0;
+};
+
+void forward_loads(World& world) {
+    size_t num_forwarded = 0;
+    Scope::for_each(world, [&] (const Scope& scope) { num_forwarded += ForwardLoads(scope).run(); });
+    VLOG("forwarded {} loads", num_forwarded);
+}
+
+}
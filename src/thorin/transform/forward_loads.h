@@ -0,0 +1,17 @@
+#ifndef THORIN_TRANSFORM_FORWARD_LOADS_H
+#define THORIN_TRANSFORM_FORWARD_LOADS_H
+
+namespace thorin {
+
+class World;
+
+/**
+ * Replaces @p Load%s by the value an earlier @p Load or @p Store already produced for the same pointer.
+ * The memory state is tracked along the mem chain and across continuations that are only reached from known predecessors.
+ * Calls and pointers that may alias - in particular through params - invalidate the known values.
+ */
+void forward_loads(World&);
+
+}
+
+#endif
@@ -0,0 +1,132 @@
+#include "thorin/primop.h"
+#include "thorin/world.h"
+#include "thorin/analyses/alias.h"
+#include "thorin/analyses/cfg.h"
+#include "thorin/analyses/induction.h"
+#include "thorin/analyses/looptree.h"
+#include "thorin/analyses/schedule.h"
+#include "thorin/analyses/scope.h"
+#include "thorin/transform/hoist_allocs.h"
+#include "thorin/util/log.h"
+
+namespace thorin {
+
+typedef LoopTree<true>::Head Head;
+
+class HoistAllocs {
+public:
+    HoistAllocs(const Scope& scope)
+        : scope_(scope)
+        , schedule_(scope, Schedule::Late)
+    {}
+
+    World& world() const { return scope_.world(); }
+    size_t num_slots() const { return num_slots_; }
+    size_t num_hoisted() const { return num_hoisted_; }
+
+    /// Handles the first suitable @p Alloc in the innermost loop possible - returns whether something changed.
+    bool run() { return run(scope_.f_cfg().looptree().root()); }
+
+private:
+    bool run(const Head* head) {
+        for (const auto& child : head->children()) {
+            if (auto child_head = child->isa<Head>()) {
+                if (run(child_head))
+                    return true;
+            }
+        }
+
+        if (head->is_root())
+            return false;
+
+        Induction induction(scope_, head);
+        if (!induction.is_valid())
+            return false;
+
+        for (const auto& block : schedule_) {
+            if (!induction.blocks().contains(block.continuation()))
+                continue;
+            for (auto primop : block) {
+                auto alloc = primop->isa<Alloc>();
+                if (alloc == nullptr || alloc->is_replaced() || !is_local_alloc(alloc))
+                    continue;
+                if (is_zero(alloc->extra()) && slot_size(alloc->alloced_type()) <= max_slot_size) {
+                    to_slot(alloc);
+                    return true;
+                }
+                auto header = induction.header();
+                if (induction.is_invariant(alloc->extra()) && header->mem_param() != nullptr && header->filter().empty()) {
+                    hoist(induction, alloc);
+                    return true;
+                }
+            }
+        }
+
+        return false;
+    }
+
+    /// Does the memory of @p alloc not escape - so that it doesn't outlive the current iteration?
+    static bool is_local_alloc(const Alloc* alloc) {
+        for (auto use : alloc->uses()) {
+            if (Alloc::is_out_ptr(use) && !is_local(use))
+                return false;
+        }
+        return true;
+    }
+
+    void to_slot(const Alloc* alloc) {
+        DLOG("replacing {} by a slot", alloc);
+        auto enter = world().enter(alloc->mem(), alloc->debug());
+        auto slot = world().slot(alloc->alloced_type(), world().extract(enter, 1_u32), alloc->debug());
+        alloc->replace(world().tuple({world().extract(enter, 0_u32), slot}, alloc->debug()));
+        ++num_slots_;
+    }
+
+    /// Allocates the buffer on all entries into the loop and passes it through an additional param of the header.
+    void hoist(const Induction& induction, const Alloc* alloc) {
+        auto header = induction.header();
+        DLOG("hoisting {} out of loop {}", alloc, header);
+
+        auto mem_index = header->mem_param()->index();
+        auto param = header->append_param(alloc->out_ptr_type(), alloc->debug());
+        for (auto use : header->copy_uses()) {
+            auto caller = use->as_continuation();
+            Array<const Def*> args(caller->num_args() + 1);
+            std::copy(caller->args().begin(), caller->args().end(), args.begin());
+            if (induction.blocks().contains(caller)) {
+                args.back() = param;
+            } else {
+                auto new_alloc = world().alloc(alloc->alloced_type(), args[mem_index], alloc->extra(), alloc->debug());
+                args[mem_index] = world().extract(new_alloc, 0_u32);
+                args.back() = world().extract(new_alloc, 1_u32);
+            }
+            caller->jump(header, args, caller->jump_debug());
+        }
+        alloc->replace(world().tuple({alloc->mem(), param}, alloc->debug()));
+        ++num_hoisted_;
+    }
+
+    const Scope& scope_;
+    Schedule schedule_;
+    size_t num_slots_ = 0;
+    size_t num_hoisted_ = 0;
+};
+
+void hoist_allocs(World& world) {
+    size_t num_slots = 0, num_hoisted = 0;
+    bool todo = true;
+    while (todo) {
+        todo = false;
+        Scope::for_each(world, [&] (const Scope& scope) {
+            HoistAllocs hoist(scope);
+            todo |= hoist.run();
+            num_slots += hoist.num_slots();
+            num_hoisted += hoist.num_hoisted();
+        });
+        if (todo)
+            world.cleanup(); // rebuild the memory chains for the next schedule
+    }
+    VLOG("replaced {} allocs in loops by slots, hoisted {} allocs out of loops", num_slots, num_hoisted);
+}
+
+}
@@ -0,0 +1,17 @@
+#ifndef THORIN_TRANSFORM_HOIST_ALLOCS_H
+#define THORIN_TRANSFORM_HOIST_ALLOCS_H
+
+namespace thorin {
+
+class World;
+
+/**
+ * Removes heap allocations from loops whose memory does not escape a single iteration.
+ * Small allocations of constant size become @p Slot%s.
+ * The others are allocated once before the loop and the buffer is reused by all iterations.
+ */
+void hoist_allocs(World&);
+
+}
+
+#endif
@@ -0,0 +1,234 @@
+#include "thorin/primop.h"
+#include "thorin/world.h"
+#include "thorin/analyses/alias.h"
+#include "thorin/analyses/cfg.h"
+#include "thorin/analyses/domtree.h"
+#include "thorin/analyses/induction.h"
+#include "thorin/analyses/looptree.h"
+#include "thorin/analyses/schedule.h"
+#include "thorin/analyses/scope.h"
+#include "thorin/transform/hoist_loads.h"
+#include "thorin/util/log.h"
+
+namespace thorin {
+
+typedef LoopTree<true>::Head Head;
+
+/// A pointer into a @p Global, @p Slot or @p Alloc through constant indices only can always be dereferenced.
+static bool is_dereferenceable(const Def* ptr) {
+    while (auto lea = ptr->isa<LEA>()) {
+        if (!lea->index()->isa<PrimLit>())
+            return false;
+        ptr = lea->ptr();
+    }
+    return is_object(ptr);
+}
+
+class HoistLoads {
+public:
+    HoistLoads(const Scope& scope)
+        : scope_(scope)
+        , cfg_(scope.f_cfg())
+    {}
+
+    World& world() const { return scope_.world(); }
+
+    /// Hoists the loads of the innermost loop that has some - returns the number of hoisted loads.
+    size_t run() { return run(cfg_.looptree().root()); }
+
+private:
+    size_t run(const Head* head) {
+        for (const auto& child : head->children()) {
+            if (auto child_head = child->isa<Head>()) {
+                if (auto num = run(child_head))
+                    return num;
+            }
+        }
+
+        return head->is_root() ? 0 : hoist(head);
+    }
+
+    size_t hoist(const Head* head) {
+        // we only know all entries into the loop if the header is merely called - see Induction
+        Induction induction(scope_, head);
+        if (!induction.is_valid() || induction.header()->mem_param() == nullptr)
+            return 0;
+        induction_ = &induction;
+        auto header = induction.header();
+        auto mem_param = header->mem_param();
+
+        loads_.clear();
+        writes_.clear();
+        clobbered_ = false;
+        DefSet done;
+        for (auto block : induction.blocks()) {
+            for (auto param : block->params()) {
+                if (param->type()->isa<MemType>())
+                    collect_memops(param, done);
+            }
+        }
+
+        std::vector<const Load*> hoisted;
+        for (auto load : loads_) {
+            if (can_hoist(load, header))
+                hoisted.push_back(load);
+        }
+
+        if (hoisted.empty())
+            return 0;
+
+        // build preheader: load all hoisted pointers and continue with the header
+        auto preheader = world().continuation(header->type(), header->debug_history());
+        preheader->debug().set(header->name() + "_preheader");
+        Array<const Def*> args(header->num_params());
+        for (size_t i = 0, e = header->num_params(); i != e; ++i) {
+            preheader->param(i)->debug().set(header->param(i)->name());
+            args[i] = preheader->param(i);
+        }
+
+        const Def* mem = preheader->param(mem_param->index());
+        Def2Def ptr2val;
+        for (auto load : hoisted) {
+            if (!ptr2val.contains(load->ptr())) {
+                auto tuple = world().load(mem, load->ptr(), load->debug());
+                mem = world().extract(tuple, 0_u32, load->debug());
+                ptr2val[load->ptr()] = world().extract(tuple, 1_u32, load->debug());
+            }
+        }
+        args[mem_param->index()] = mem;
+        preheader->jump(header, args, header->jump_debug());
+
+        for (auto entry : induction.entries())
+            entry->update_callee(preheader);
+
+        for (auto load : hoisted) {
+            DLOG("hoisting {} out of loop {}", load, header);
+            load->replace(world().tuple({ load->mem(), ptr2val[load->ptr()] }, load->debug()));
+        }
+
+        return hoisted.size();
+    }
+
+    /// Collects all @p Load%s and @p Store%s along the mem chain starting at @p mem.
+    void collect_memops(const Def* mem, DefSet& done) {
+        if (!done.emplace(mem).second)
+            return;
+
+        for (auto use : mem->uses()) {
+            if (use->is_replaced())
+                continue; // hoisted in a previous round
+            if (auto continuation = use->isa_continuation()) {
+                // a call may write anything - leaving the loop doesn't matter
+                auto callee = continuation->callee()->isa_continuation();
+                if (callee == nullptr || !induction_->blocks().contains(callee)) {
+                    for (auto arg : continuation->args()) {
+                        if (auto target = arg->isa_continuation())
+                            clobbered_ |= induction_->blocks().contains(target);
+                    }
+                }
+            } else if (use.index() != 0) {
+                clobbered_ = true;
+            } else if (auto load = use->isa<Load>()) {
+                loads_.push_back(load);
+                collect_memops(load->out_mem(), done);
+            } else if (auto store = use->isa<Store>()) {
+                writes_.push_back(store->ptr());
+                collect_memops(store, done);
+            } else if (auto memop = use->isa<MemOp>()) {
+                clobbered_ |= !memop->isa<Enter>() && !memop->isa<Alloc>();
+                collect_memops(memop->out_mem(), done);
+            } else {
+                clobbered_ = true;
+            }
+        }
+    }
+
+    bool can_hoist(const Load* load, Continuation* header) {
+        auto ptr = load->ptr();
+        if (!induction_->is_invariant(ptr))
+            return false;
+
+        // a load which may trap must not be speculated - it has to run on each entry into the loop anyway
+        if (!is_dereferenceable(ptr) && !is_executed_on_entry(load, header))
+            return false;
+
+        auto object = base_object(ptr);
+        bool immutable = object->isa<Global>() && !object->as<Global>()->is_mutable();
+        if (immutable)
+            return true;
+        if (clobbered_ && !is_local(object))
+            return false;
+
+        for (auto write : writes_) {
+            if (may_alias(write, ptr))
+                return false;
+        }
+        return true;
+    }
+
+    /**
+     * Is @p load executed each time the loop is entered? This is the case if it is placed in the header or in a block
+     * which dominates all exits of the loop.
+     * Note that using the header's mem doesn't suffice: targets of branches inside the loop use it as a free variable.
+     */
+    bool is_executed_on_entry(const Load* load, Continuation* header) {
+        if (load2node_.empty()) {
+            for (const auto& block : schedule(scope_)) {
+                for (auto primop : block) {
+                    if (auto l = primop->isa<Load>())
+                        load2node_[l] = block.node();
+                }
+            }
+        }
+
+        auto i = load2node_.find(load);
+        if (i == load2node_.end())
+            return false;
+        auto node = i->second;
+        if (node->continuation() == header)
+            return true;
+        if (!induction_->blocks().contains(node->continuation()))
+            return false;
+
+        const auto& domtree = cfg_.domtree();
+        for (auto block : induction_->blocks()) {
+            auto n = cfg_[block];
+            for (auto succ : cfg_.succs(n)) {
+                if (induction_->blocks().contains(succ->continuation()))
+                    continue;
+                // n leaves the loop - node must dominate it
+                auto dom = n;
+                while (dom != node && dom != domtree.root())
+                    dom = domtree.idom(dom);
+                if (dom != node)
+                    return false;
+            }
+        }
+        return true;
+    }
+
+    const Scope& scope_;
+    const F_CFG& cfg_;
+    const Induction* induction_ = nullptr; ///< the loop currently inspected
+    std::vector<const Load*> loads_;
+    std::vector<const Def*> writes_;
+    DefMap<const CFNode*> load2node_; ///< placement of all loads in the @p Schedule - built on demand
+    bool clobbered_;
+};
+
+void hoist_loads(World& world) {
+    size_t num_hoisted = 0;
+    bool todo = true;
+    while (todo) {
+        todo = false;
+        Scope::for_each(world, [&] (const Scope& scope) {
+            if (auto num = HoistLoads(scope).run()) {
+                num_hoisted += num;
+                todo = true;
+            }
+        });
+    }
+    VLOG("hoisted {} loads out of loops", num_hoisted);
+}
+
+}
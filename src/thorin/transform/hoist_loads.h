@@ -0,0 +1,17 @@
+#ifndef THORIN_TRANSFORM_HOIST_LOADS_H
+#define THORIN_TRANSFORM_HOIST_LOADS_H
+
+namespace thorin {
+
+class World;
+
+/**
+ * Loop-invariant code motion for @p Load%s.
+ * A @p Load whose pointer doesn't depend on the loop and whose memory isn't written within the loop is moved into a new
+ * preheader @p Continuation that is called instead of the loop header from outside the loop.
+ */
+void hoist_loads(World&);
+
+}
+
+#endif
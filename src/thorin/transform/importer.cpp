@@ -66,10 +66,8 @@ const Def* Importer::import(Tracker odef) {
         if (ocontinuation->is_external())
             ncontinuation->make_external();
 
-        if (ocontinuation->num_ops() > 0 && ocontinuation->callee() == ocontinuation->world().branch()) {
-            auto cond = import(ocontinuation->arg(0));
-            if (auto lit = cond->isa<PrimLit>()) {
-                auto callee = import(lit->value().get_bool() ? ocontinuation->arg(1) : ocontinuation->arg(2));
+        if (ocontinuation->num_ops() > 0) {
+            if (auto callee = fold_jump(ocontinuation->callee(), ocontinuation->args(), [&] (const Def* def) { return import(def); })) {
                 ncontinuation->jump(callee, {}, ocontinuation->jump_debug());
 
                 assert(!ncontinuation->is_replaced());
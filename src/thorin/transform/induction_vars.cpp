@@ -0,0 +1,174 @@
+#include "thorin/primop.h"
+#include "thorin/world.h"
+#include "thorin/analyses/cfg.h"
+#include "thorin/analyses/induction.h"
+#include "thorin/analyses/looptree.h"
+#include "thorin/analyses/scope.h"
+#include "thorin/transform/induction_vars.h"
+#include "thorin/util/log.h"
+
+namespace thorin {
+
+typedef LoopTree<true>::Head Head;
+
+class InductionVars {
+public:
+    /// Loops are only reported in the log if they run at most this many times.
+    static const u64 max_trip_count = 1024;
+
+    InductionVars(const Scope& scope)
+        : scope_(scope)
+    {}
+
+    World& world() const { return scope_.world(); }
+
+    /// Simplifies the induction variables of the innermost loop where this is possible - returns the number of changes.
+    size_t run() { return run(scope_.f_cfg().looptree().root()); }
+
+private:
+    size_t run(const Head* head) {
+        for (const auto& child : head->children()) {
+            if (auto child_head = child->isa<Head>()) {
+                if (auto num = run(child_head))
+                    return num;
+            }
+        }
+
+        if (head->is_root())
+            return 0;
+
+        Induction induction(scope_, head);
+        if (!induction.is_valid())
+            return 0;
+
+        u64 count;
+        if (induction.trip_count(count, max_trip_count))
+            DLOG("loop {} runs {} times", induction.header(), count);
+
+        if (auto num = eliminate(induction))
+            return num;
+        return reduce(induction);
+    }
+
+    /**
+     * Yields @c d if @p b is <tt>a + d</tt> on entry into the loop for a constant @c d.
+     * As both are incremented by the same step, this holds on all iterations.
+     */
+    const Def* offset(const Induction& induction, const Induction::Var& a, const Induction::Var& b) {
+        if (a.param->type() != b.param->type() || a.step != b.step)
+            return nullptr;
+
+        const Def* result = nullptr;
+        for (auto entry : induction.entries()) {
+            auto d = world().arithop_sub(entry->arg(b.param->index()), entry->arg(a.param->index()));
+            if (!d->isa<PrimLit>() || (result != nullptr && d != result))
+                return nullptr;
+            result = d;
+        }
+        return result;
+    }
+
+    /// Replaces induction variables that merely differ by a constant from another one.
+    size_t eliminate(const Induction& induction) {
+        const auto& vars = induction.vars();
+        for (size_t i = 0, e = vars.size(); i != e; ++i) {
+            for (size_t j = i + 1; j != e; ++j) {
+                if (auto d = offset(induction, vars[i], vars[j])) {
+                    auto a = vars[i].param, b = vars[j].param;
+                    DLOG("replacing induction variable {} by {} + {}", b, a, d);
+                    b->replace(world().arithop_add(a, d, b->debug()));
+                    return 1;
+                }
+            }
+        }
+        return 0;
+    }
+
+    /// Is @p def used by a @p Continuation of the loop - maybe through other @p PrimOp%s?
+    bool is_used_in_loop(const Induction& induction, const Def* def, DefSet& done) {
+        if (!done.emplace(def).second)
+            return false;
+        for (auto use : def->uses()) {
+            if (auto continuation = use->isa_continuation()) {
+                if (induction.blocks().contains(continuation))
+                    return true;
+            } else if (is_used_in_loop(induction, use, done)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /// Yields the factor if @p use is a multiplication of @p var with a loop-invariant value within the loop.
+    const Def* factor(const Induction& induction, const Induction::Var& var, Use use) {
+        if (use->is_replaced())
+            return nullptr; // reduced in a previous round
+        auto mul = use->isa<ArithOp>();
+        if (mul == nullptr || mul->arithop_tag() != ArithOp_mul)
+            return nullptr;
+        auto factor = mul->op(1 - use.index());
+        if (factor == var.param || !induction.is_invariant(factor))
+            return nullptr;
+        DefSet done;
+        return is_used_in_loop(induction, mul, done) ? factor : nullptr;
+    }
+
+    /**
+     * Strength reduction:
+     * Each multiplication <tt>i * k</tt> of an induction variable @c i with a loop-invariant @c k within the loop is
+     * replaced by a new induction variable that starts at <tt>init * k</tt> and is incremented by <tt>step * k</tt>.
+     */
+    size_t reduce(const Induction& induction) {
+        std::vector<std::pair<const Def*, const Def*>> muls; // multiplication and its factor
+        std::vector<const Induction::Var*> vars;
+        for (const auto& var : induction.vars()) {
+            for (auto use : var.param->uses()) {
+                if (auto k = factor(induction, var, use)) {
+                    muls.emplace_back(use, k);
+                    vars.push_back(&var);
+                }
+            }
+        }
+
+        auto header = induction.header();
+        for (size_t i = 0, e = muls.size(); i != e; ++i) {
+            auto mul = muls[i].first, k = muls[i].second;
+            auto var = vars[i];
+            DLOG("strength reduction of {} in loop {}", mul, header);
+
+            auto param = header->append_param(mul->type(), mul->debug());
+            for (auto use : header->copy_uses()) {
+                auto caller = use->as_continuation();
+                Array<const Def*> args(caller->num_args() + 1);
+                std::copy(caller->args().begin(), caller->args().end(), args.begin());
+                if (induction.blocks().contains(caller))
+                    args.back() = world().arithop_add(param, world().arithop_mul(var->step, k, mul->debug()), mul->debug());
+                else
+                    args.back() = world().arithop_mul(caller->arg(var->param->index()), k, mul->debug());
+                caller->jump(header, args, caller->jump_debug());
+            }
+            mul->replace(param);
+        }
+
+        return muls.size();
+    }
+
+    const Scope& scope_;
+};
+
+void simplify_induction_vars(World& world) {
+    size_t num = 0;
+    bool todo = true;
+    while (todo) {
+        todo = false;
+        Scope::for_each(world, [&] (const Scope& scope) {
+            if (auto n = InductionVars(scope).run()) {
+                num += n;
+                todo = true;
+            }
+        });
+    }
+    VLOG("simplified {} induction variables", num);
+}
+
+}
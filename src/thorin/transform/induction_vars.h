@@ -0,0 +1,18 @@
+#ifndef THORIN_TRANSFORM_INDUCTION_VARS_H
+#define THORIN_TRANSFORM_INDUCTION_VARS_H
+
+namespace thorin {
+
+class World;
+
+/**
+ * Induction variable simplification and strength reduction - see @p Induction.
+ * Induction variables that differ from another one by a constant are replaced by it.
+ * Multiplications of an induction variable with a loop-invariant value - as they appear in index computations - become
+ * new induction variables that are incremented on each iteration.
+ */
+void simplify_induction_vars(World&);
+
+}
+
+#endif
@@ -1,13 +1,18 @@
 #include "thorin/continuation.h"
 #include "thorin/world.h"
 #include "thorin/analyses/cfg.h"
+#include "thorin/analyses/looptree.h"
 #include "thorin/analyses/scope.h"
 #include "thorin/analyses/verify.h"
 #include "thorin/transform/mangle.h"
 #include "thorin/util/log.h"
+#include "thorin/util/statistic.h"
 
 namespace thorin {
 
+THORIN_STATISTIC(num_forced,  "inliner", "call sites inlined by force_inline");
+THORIN_STATISTIC(num_inlined, "inliner", "call sites inlined");
+
 void force_inline(Scope& scope, int threshold) {
     for (bool todo = true; todo && threshold-- != 0;) {
         todo = false;
@@ -17,6 +22,7 @@ void force_inline(Scope& scope, int threshold) {
                 if (!callee->empty() && !scope.contains(callee)) {
                     Scope callee_scope(callee);
                     continuation->jump(drop(callee_scope, continuation->args()), {}, continuation->jump_debug());
+                    ++num_forced;
                     todo = true;
                 }
             }
@@ -35,62 +41,173 @@ void force_inline(Scope& scope, int threshold) {
     }
 }
 
-void inliner(World& world) {
-    VLOG("start inliner");
+/**
+ * Inlines calls bottom-up over the call graph of top-level functions driven by a simple cost model:
+ * A call site is inlined if the callee's size - after folding the known arguments - stays below a threshold.
+ * This threshold grows with the number of known arguments and with the loop depth of the call site.
+ * Each inlined copy is charged against a global growth budget.
+ */
+class Inliner {
+public:
+    Inliner(World& world, double growth)
+        : world_(world)
+        , budget_(size_t(growth * (world.primops().size() + world.continuations().size())))
+    {}
+
+    World& world() { return world_; }
+    void run();
 
+private:
     static const int factor = 4;
     static const int offset = 4;
+    static const int known_bonus = 4; ///< extra threshold for each known argument
+    static const int max_depth = 3;   ///< deeper loops don't raise the threshold any further
 
-    ContinuationMap<std::unique_ptr<Scope>> continuation2scope;
-
-    auto get_scope = [&] (Continuation* continuation) -> Scope* {
-        auto i = continuation2scope.find(continuation);
-        if (i == continuation2scope.end())
-            i = continuation2scope.emplace(continuation, std::make_unique<Scope>(continuation)).first;
-        return i->second.get();
-    };
-
-    auto is_candidate = [&] (Continuation* continuation) -> Scope* {
-        if (!continuation->empty() && continuation->order() > 1) {
-            auto scope = get_scope(continuation);
-            if (scope->defs().size() < scope->entry()->num_params() * factor + offset) {
-                // check that the function is not recursive to prevent inliner from peeling loops
-                for (auto& use : continuation->uses()) {
-                    // note that if there was an edge from parameter to continuation,
-                    // we would need to check if the use is a parameter here.
-                    if (scope->contains(use.def()))
-                        return nullptr;
-                }
-                return scope;
-            }
+    static bool is_function(Continuation* continuation) { return !continuation->empty() && continuation->order() > 1; }
+    /// Literals, constant expressions and functions are known - passing a return continuation doesn't help.
+    static bool is_known_arg(const Def* arg) { return arg->isa_continuation() ? arg->order() > 1 : is_const(arg); }
+    Scope* get_scope(Continuation*);
+    bool is_recursive(const Scope&);
+    bool is_known(const Def*, DefMap<bool>&);
+    size_t folded_size(const Scope&, Defs args);
+    void visit(Continuation*);
+    void inline_calls(Continuation*);
+
+    template<typename... Args>
+    static void remark(Continuation* call, const char* fmt, Args... args) {
+        Log::log(Log::Verbose, call->jump_location(), fmt, args...);
+    }
+
+    World& world_;
+    size_t budget_;
+    size_t num_inlined_ = 0;
+    ContinuationMap<std::unique_ptr<Scope>> continuation2scope_;
+    ContinuationSet done_;
+};
+
+Scope* Inliner::get_scope(Continuation* continuation) {
+    auto i = continuation2scope_.find(continuation);
+    if (i == continuation2scope_.end())
+        i = continuation2scope_.emplace(continuation, std::make_unique<Scope>(continuation)).first;
+    return i->second.get();
+}
+
+bool Inliner::is_recursive(const Scope& scope) {
+    // note that if there was an edge from parameter to continuation,
+    // we would need to check if the use is a parameter here.
+    for (auto& use : scope.entry()->uses()) {
+        if (scope.contains(use.def()))
+            return true;
+    }
+    return false;
+}
+
+/// Will @p def fold to a constant once the known arguments are in place?
+bool Inliner::is_known(const Def* def, DefMap<bool>& known) {
+    auto i = known.find(def);
+    if (i != known.end())
+        return i->second;
+
+    bool result = false;
+    if (def->isa_continuation()) {
+        result = true;
+    } else if (auto primop = def->isa<PrimOp>()) {
+        result = !primop->isa<MemOp>() && !primop->isa<Slot>();
+        for (auto op : primop->ops())
+            result = result && is_known(op, known);
+    }
+
+    return known[def] = result;
+}
+
+size_t Inliner::folded_size(const Scope& scope, Defs args) {
+    DefMap<bool> known;
+    for (size_t i = 0, e = args.size(); i != e; ++i)
+        known[scope.entry()->param(i)] = is_const(args[i]);
+
+    size_t size = 0;
+    for (auto def : scope.defs()) {
+        if (def->isa_continuation() || (def->isa<PrimOp>() && !is_known(def, known)))
+            ++size;
+    }
+    return size;
+}
+
+void Inliner::visit(Continuation* continuation) {
+    if (!done_.emplace(continuation).second)
+        return;
+
+    // first process all top-level callees - so we see their sizes after inlining
+    auto scope = get_scope(continuation);
+    for (auto n : scope->f_cfg().post_order()) {
+        if (auto callee = n->continuation()->callee()->isa_continuation()) {
+            if (is_function(callee) && !scope->contains(callee) && !get_scope(callee)->has_free_params())
+                visit(callee);
         }
-        return nullptr;
-    };
+    }
 
-    Scope::for_each(world, [&] (Scope& scope) {
-        bool dirty = false;
-        for (auto n : scope.f_cfg().post_order()) {
-            auto continuation = n->continuation();
-            if (auto callee = continuation->callee()->isa_continuation()) {
-                if (callee == scope.entry())
-                    continue; // don't inline recursive calls
-                DLOG("callee: {}", callee);
-                if (auto callee_scope = is_candidate(callee)) {
-                    DLOG("- here: {}", continuation);
-                    continuation->jump(drop(*callee_scope, continuation->args()), {}, continuation->jump_debug());
-                    dirty = true;
-                }
-            }
+    inline_calls(continuation);
+}
+
+void Inliner::inline_calls(Continuation* entry) {
+    auto scope = get_scope(entry);
+    const auto& looptree = scope->f_cfg().looptree();
+    bool dirty = false;
+
+    for (auto n : scope->f_cfg().post_order()) {
+        auto continuation = n->continuation();
+        auto callee = continuation->callee()->isa_continuation();
+        if (callee == nullptr || callee == entry || !is_function(callee))
+            continue; // don't inline recursive calls
+
+        auto callee_scope = get_scope(callee);
+        if (is_recursive(*callee_scope)) {
+            remark(continuation, "not inlining recursive '{}' into '{}'", callee, entry);
+            continue;
         }
 
-        if (dirty) {
-            scope.update();
+        size_t num_known = 0;
+        for (auto arg : continuation->args())
+            num_known += is_known_arg(arg) ? 1 : 0;
 
-            if (auto s = get_scope(scope.entry()))
-                s->update();
+        // nodes outside of any loop are at depth 1
+        auto depth = std::min(std::max(looptree[n]->depth() - 1, 0), int(max_depth));
+        auto size = folded_size(*callee_scope, continuation->args());
+        auto threshold = (callee->num_params() * factor + offset + num_known * known_bonus) * (1 + depth);
+        // the original callee dies if this is its only use
+        auto cost = callee->num_uses() == 1 && !callee->is_external() ? 0 : size;
+
+        if (size >= threshold) {
+            remark(continuation, "not inlining '{}' into '{}': size {} exceeds threshold {} (loop depth {}, {} known arguments)",
+                   callee, entry, size, threshold, depth, num_known);
+        } else if (cost > budget_) {
+            remark(continuation, "not inlining '{}' into '{}': size {} exceeds remaining budget {}", callee, entry, size, budget_);
+        } else {
+            remark(continuation, "inlining '{}' into '{}': size {} below threshold {} (loop depth {}, {} known arguments)",
+                   callee, entry, size, threshold, depth, num_known);
+            continuation->jump(drop(*callee_scope, continuation->args()), {}, continuation->jump_debug());
+            budget_ -= cost;
+            ++num_inlined_;
+            ++num_inlined;
+            dirty = true;
         }
-    });
+    }
 
+    if (dirty)
+        scope->update();
+}
+
+void Inliner::run() {
+    for (auto continuation : world().copy_continuations()) {
+        if (is_function(continuation) && !get_scope(continuation)->has_free_params())
+            visit(continuation);
+    }
+    VLOG("inlined {} call sites - remaining budget: {}", num_inlined_, budget_);
+}
+
+void inliner(World& world, double growth) {
+    VLOG("start inliner");
+    Inliner(world, growth).run();
     VLOG("stop inliner");
     debug_verify(world);
     world.cleanup();
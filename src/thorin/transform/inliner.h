@@ -11,7 +11,13 @@ class World;
  * If there still remain functions to be inlined, warnings will be emitted
  */
 void force_inline(Scope& scope, int threshold);
-void inliner(World& world);
+
+/**
+ * Inlines calls to small functions bottom-up over the call graph.
+ * Known arguments and enclosing loops make a call site more attractive.
+ * The module may grow by at most a fraction of @p growth of its initial size.
+ */
+void inliner(World& world, double growth = 0.5);
 
 }
 
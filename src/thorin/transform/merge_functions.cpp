@@ -0,0 +1,270 @@
+#include <algorithm>
+#include <map>
+
+#include "thorin/primop.h"
+#include "thorin/world.h"
+#include "thorin/analyses/scope.h"
+#include "thorin/transform/mangle.h"
+#include "thorin/transform/merge_functions.h"
+#include "thorin/util/hash.h"
+#include "thorin/util/log.h"
+
+namespace thorin {
+
+/// Structural comparison of two @p Scope%s.
+class Comparison {
+public:
+    /// The op @p index of @p def in the first @p Scope is the literal @p lit in the second one - but a different one.
+    struct Diff {
+        const Def* def;
+        size_t index;
+        const Def* lit;
+    };
+
+    Comparison(const Scope& a, const Scope& b)
+        : a_(a)
+        , b_(b)
+    {}
+
+    /// Are both @p Scope%s equal up to the @p diffs?
+    bool run() { return a_.entry()->type() == b_.entry()->type() && equal(a_.entry(), b_.entry()); }
+    const std::vector<Diff>& diffs() const { return diffs_; }
+
+private:
+    bool equal(const Def* a, const Def* b) {
+        bool within = a_.contains(a);
+        if (within != b_.contains(b))
+            return false;
+        if (!within)
+            return a == b;
+
+        auto i = a2b_.find(a);
+        if (i != a2b_.end())
+            return i->second == b;
+        if (b_mapped_.contains(b))
+            return false;
+        a2b_[a] = b;
+        b_mapped_.insert(b);
+
+        if (a->tag() != b->tag() || a->type() != b->type() || a->num_ops() != b->num_ops())
+            return false;
+
+        if (auto pa = a->isa<Param>())
+            return pa->index() == b->as<Param>()->index() && equal(pa->continuation(), b->as<Param>()->continuation());
+
+        if (auto ca = a->isa_continuation()) {
+            auto cb = b->as_continuation();
+            if (ca->intrinsic() != cb->intrinsic() || ca->cc() != cb->cc() || ca->empty() != cb->empty())
+                return false;
+        }
+
+        if (a->isa<Assembly>())
+            return false;
+
+        for (size_t i = 0, e = a->num_ops(); i != e; ++i) {
+            auto x = a->op(i), y = b->op(i);
+            if (x != y && x->isa<PrimLit>() && y->isa<PrimLit>() && is_liftable(a, i))
+                diffs_.push_back({a, i, y});
+            else if (!equal(x, y))
+                return false;
+        }
+        return true;
+    }
+
+    /// May op @p index of @p def become a param?
+    static bool is_liftable(const Def* def, size_t index) {
+        if (auto continuation = def->isa_continuation()) {
+            auto callee = continuation->callee()->isa_continuation();
+            return index != 0 && (callee == nullptr || !callee->is_intrinsic());
+        }
+        return def->isa<ArithOp>() || def->isa<Cmp>() || (def->isa<Store>() && index == 2) || (def->isa<Select>() && index != 0);
+    }
+
+    const Scope& a_;
+    const Scope& b_;
+    Def2Def a2b_;
+    DefSet b_mapped_;
+    std::vector<Diff> diffs_;
+};
+
+class MergeFunctions {
+public:
+    /// Only merge functions that differ in at most this many constants.
+    static const size_t max_constants = 4;
+
+    MergeFunctions(World& world)
+        : world_(world)
+    {}
+
+    World& world() const { return world_; }
+    size_t num_merged() const { return num_merged_; }
+    size_t num_lifted() const { return num_lifted_; }
+
+    void run() {
+        // literals are hashed by their type only - so functions that differ in constants end up in the same bucket
+        std::map<uint64_t, std::vector<Continuation*>> buckets;
+        Scope::for_each(world(), [&] (const Scope& scope) {
+            auto entry = scope.entry();
+            if (!entry->is_intrinsic() && !is_passed_to_accelerator(entry))
+                buckets[hash(scope)].push_back(entry);
+        });
+
+        for (auto& p : buckets) {
+            auto& bucket = p.second;
+            // keep externals
+            std::stable_partition(bucket.begin(), bucket.end(), [&] (Continuation* continuation) { return world().is_external(continuation); });
+            for (size_t i = 0, e = bucket.size(); i != e; ++i) {
+                if (!done_.contains(bucket[i]))
+                    merge(bucket, i);
+            }
+        }
+    }
+
+private:
+    uint64_t hash(const Scope& scope) {
+        DefMap<size_t> indices;
+        std::function<uint64_t(const Def*)> hash = [&] (const Def* def) -> uint64_t {
+            if (!scope.contains(def))
+                return def->isa<PrimLit>() ? hash_combine(hash_begin(int(def->tag())), def->type()->gid()) : murmur3(def->gid());
+
+            auto i = indices.find(def);
+            if (i != indices.end())
+                return i->second;
+            auto index = indices.size();
+            indices[def] = index;
+
+            auto result = hash_combine(hash_begin(int(def->tag())), def->type()->gid(), def->num_ops());
+            if (auto param = def->isa<Param>())
+                return hash_combine(result, param->index(), hash(param->continuation()));
+            for (auto op : def->ops())
+                result = hash_combine(result, hash(op));
+            return result;
+        };
+        return hash(scope.entry());
+    }
+
+    /// Do we know all calls of @p continuation - and can we redirect them?
+    static bool is_called(Continuation* continuation) { return continuation->filter().empty() && continuation->has_known_calls(); }
+
+    /// Merges all functions of @p bucket after @p i into @p bucket[i] where possible.
+    void merge(const std::vector<Continuation*>& bucket, size_t i) {
+        auto f = bucket[i];
+        Scope scope(f);
+
+        std::vector<Continuation*> group;                            // functions that differ from f in constants
+        std::vector<std::vector<Comparison::Diff>> group_diffs;
+        std::vector<std::pair<const Def*, size_t>> positions;        // all ops of f's scope that become params
+        for (size_t j = i + 1, e = bucket.size(); j != e; ++j) {
+            auto g = bucket[j];
+            if (done_.contains(g) || world().is_external(g))
+                continue;
+
+            Scope other(g);
+            Comparison comparison(scope, other);
+            if (!comparison.run())
+                continue;
+
+            if (comparison.diffs().empty()) {
+                DLOG("merging {} into {}", g, f);
+                g->replace(f);
+                done_.insert(g);
+                ++num_merged_;
+                continue;
+            }
+
+            if (!is_called(f) || !is_called(g))
+                continue;
+            auto new_positions = positions;
+            for (const auto& diff : comparison.diffs()) {
+                auto position = std::make_pair(diff.def, diff.index);
+                if (std::find(new_positions.begin(), new_positions.end(), position) == new_positions.end())
+                    new_positions.push_back(position);
+            }
+            if (new_positions.size() <= max_constants) {
+                positions.swap(new_positions);
+                group.push_back(g);
+                group_diffs.push_back(comparison.diffs());
+            }
+        }
+
+        if (!group.empty())
+            lift(scope, positions, group, group_diffs);
+    }
+
+    /// Clones @p scope and turns the ops at @p positions into params - @p group and the entry then call this clone.
+    void lift(const Scope& scope, const std::vector<std::pair<const Def*, size_t>>& positions,
+              const std::vector<Continuation*>& group, const std::vector<std::vector<Comparison::Diff>>& group_diffs) {
+        auto f = scope.entry();
+        Array<const Def*> args(f->num_params()); // clone
+        Mangler mangler(scope, args, Defs());
+        auto lifted = mangler.mangle();
+
+        // check before changing anything - the clone doesn't contain folded branches
+        for (const auto& position : positions) {
+            auto def = mangler.def2def(position.first);
+            if (def == nullptr || def->op(position.second) != position.first->op(position.second))
+                return;
+        }
+
+        DLOG("merging {} functions into {} with {} constants as params", group.size(), f, positions.size());
+        DefMap<std::vector<std::pair<size_t, const Def*>>> new_ops;
+        for (const auto& position : positions) {
+            auto param = lifted->append_param(position.first->op(position.second)->type());
+            new_ops[mangler.def2def(position.first)].emplace_back(position.second, param);
+        }
+        for (const auto& p : new_ops) {
+            if (auto continuation = p.first->isa_continuation()) {
+                for (const auto& op : p.second)
+                    continuation->update_op(op.first, op.second);
+            } else {
+                auto primop = p.first->as<PrimOp>();
+                Array<const Def*> ops(primop->ops());
+                for (const auto& op : p.second)
+                    ops[op.first] = op.second;
+                primop->replace(primop->rebuild(ops));
+            }
+        }
+
+        // recursive calls of the clone pass the constants through
+        for (auto use : lifted->copy_uses()) {
+            auto caller = use->as_continuation();
+            if (caller->num_args() != lifted->num_params())
+                caller->jump(lifted, concat(caller->args(), lifted->params().get_back(positions.size())), caller->jump_debug());
+        }
+
+        auto redirect = [&] (Continuation* continuation, const std::vector<Comparison::Diff>& diffs) {
+            Array<const Def*> constants(positions.size());
+            for (size_t k = 0, e = positions.size(); k != e; ++k)
+                constants[k] = positions[k].first->op(positions[k].second);
+            for (const auto& diff : diffs) {
+                auto k = std::find(positions.begin(), positions.end(), std::make_pair(diff.def, diff.index)) - positions.begin();
+                constants[k] = diff.lit;
+            }
+            for (auto use : continuation->copy_uses()) {
+                auto caller = use->as_continuation();
+                caller->jump(lifted, concat(caller->args(), constants), caller->jump_debug());
+            }
+            done_.insert(continuation);
+        };
+
+        redirect(f, {});
+        for (size_t k = 0, e = group.size(); k != e; ++k)
+            redirect(group[k], group_diffs[k]);
+        num_lifted_ += group.size();
+    }
+
+    World& world_;
+    ContinuationSet done_;
+    size_t num_merged_ = 0;
+    size_t num_lifted_ = 0;
+};
+
+void merge_functions(World& world) {
+    MergeFunctions merge(world);
+    merge.run();
+    VLOG("merged {} identical functions, merged {} functions differing in constants", merge.num_merged(), merge.num_lifted());
+    if (merge.num_merged() + merge.num_lifted() != 0)
+        world.cleanup();
+}
+
+}
@@ -0,0 +1,17 @@
+#ifndef THORIN_TRANSFORM_MERGE_FUNCTIONS_H
+#define THORIN_TRANSFORM_MERGE_FUNCTIONS_H
+
+namespace thorin {
+
+class World;
+
+/**
+ * Merges top-level functions that are structurally identical - modulo gids and names.
+ * Functions whose calls are all known and that merely differ in a few constants are merged as well:
+ * These constants become params of the merged function.
+ */
+void merge_functions(World&);
+
+}
+
+#endif
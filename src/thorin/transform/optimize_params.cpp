@@ -0,0 +1,264 @@
+#include <algorithm>
+
+#include "thorin/continuation.h"
+#include "thorin/primop.h"
+#include "thorin/world.h"
+#include "thorin/analyses/schedule.h"
+#include "thorin/analyses/scope.h"
+#include "thorin/transform/optimize_params.h"
+#include "thorin/util/log.h"
+
+namespace thorin {
+
+class OptimizeParams {
+public:
+    OptimizeParams(World& world)
+        : world_(world)
+    {}
+
+    World& world() const { return world_; }
+    size_t num_returns() const { return num_returns_; }
+    size_t num_promoted() const { return num_promoted_; }
+
+    void run() {
+        bool todo = true;
+        while (todo) {
+            todo = false;
+            for (auto continuation : world().copy_continuations()) {
+                if (!is_candidate(continuation))
+                    continue;
+                // both replace the continuation
+                if (eliminate_returns(continuation) || promote(continuation))
+                    todo = true;
+            }
+        }
+    }
+
+private:
+    /// Is @p continuation a function - not a basic block or loop header - whose calls we all know?
+    static bool is_candidate(Continuation* continuation) {
+        return !continuation->empty() && continuation->order() > 1 && continuation->has_known_calls();
+    }
+
+    /// The only param of function type - @c nullptr if there is none or more than one.
+    static const Param* ret_param(Continuation* continuation) {
+        const Param* result = nullptr;
+        for (auto param : continuation->params()) {
+            if (param->order() >= 1) {
+                if (result != nullptr || !param->type()->isa<FnType>())
+                    return nullptr;
+                result = param;
+            }
+        }
+        return result;
+    }
+
+    /// Creates the replacement of @p ocontinuation with type @p type - all params but the ones in @p changed are replaced.
+    Continuation* rebuild(Continuation* ocontinuation, const FnType* type, ArrayRef<size_t> changed) {
+        auto ncontinuation = world().continuation(type, ocontinuation->cc(), ocontinuation->intrinsic(), ocontinuation->debug_history());
+        for (size_t i = 0, e = ocontinuation->num_params(); i != e; ++i) {
+            if (std::find(changed.begin(), changed.end(), i) == changed.end())
+                ocontinuation->param(i)->replace(ncontinuation->param(i));
+            ncontinuation->param(i)->debug() = ocontinuation->param(i)->debug_history();
+        }
+        if (!ocontinuation->filter().empty())
+            ncontinuation->set_filter(ocontinuation->filter());
+        return ncontinuation;
+    }
+
+    /**
+     * Removes the args of the return continuation of @p ocontinuation that are unused by all callers.
+     * Each caller either passes a return continuation that is only used for calls of @p ocontinuation or - in case of a
+     * recursive call - the return param itself.
+     */
+    bool eliminate_returns(Continuation* ocontinuation) {
+        auto ret = ret_param(ocontinuation);
+        if (ret == nullptr)
+            return false;
+        auto index = ret->index();
+
+        std::vector<Continuation*> rets;
+        for (auto use : ocontinuation->uses()) {
+            auto arg = use->as_continuation()->arg(index);
+            if (arg == ret)
+                continue;
+            auto k = arg->isa_continuation();
+            if (k == nullptr || k->empty() || k->is_intrinsic() || world().is_external(k))
+                return false;
+            for (auto k_use : k->uses()) {
+                auto caller = k_use->isa_continuation();
+                if (caller == nullptr || k_use.index() != index + 1 || caller->callee() != ocontinuation)
+                    return false;
+            }
+            if (std::find(rets.begin(), rets.end(), k) == rets.end())
+                rets.push_back(k);
+        }
+        if (rets.empty())
+            return false;
+
+        for (auto use : ret->uses()) {
+            auto continuation = use->isa_continuation();
+            if (continuation == nullptr)
+                return false;
+            if (use.index() != 0 && (use.index() != index + 1 || continuation->callee() != ocontinuation))
+                return false;
+        }
+
+        std::vector<size_t> dead;
+        for (size_t i = 0, e = ret->type()->num_ops(); i != e; ++i) {
+            if (ret->type()->op(i)->isa<MemType>())
+                continue;
+            if (std::all_of(rets.begin(), rets.end(), [&] (Continuation* k) { return k->param(i)->num_uses() == 0; }))
+                dead.push_back(i);
+        }
+        if (dead.empty())
+            return false;
+
+        DLOG("removing {} unused return values of {}", dead.size(), ocontinuation);
+        auto ret_type = world().fn_type(ret->type()->ops().cut(dead));
+        Array<const Type*> types(ocontinuation->type()->ops());
+        types[index] = ret_type;
+        auto ncontinuation = rebuild(ocontinuation, world().fn_type(types), {index});
+        auto new_ret = ncontinuation->param(index);
+
+        for (auto use : ret->copy_uses()) {
+            if (use.index() == 0) {
+                auto continuation = use->as_continuation();
+                continuation->jump(new_ret, continuation->args().cut(dead), continuation->jump_debug());
+            }
+        }
+        ncontinuation->jump(ocontinuation->callee(), ocontinuation->args(), ocontinuation->jump_debug());
+        ocontinuation->destroy_body();
+
+        Def2Def new_rets;
+        for (auto k : rets) {
+            auto new_k = world().continuation(ret_type, k->cc(), k->intrinsic(), k->debug_history());
+            for (size_t i = 0, j = 0, e = k->num_params(); i != e; ++i) {
+                if (j != dead.size() && dead[j] == i) {
+                    ++j;
+                } else {
+                    k->param(i)->replace(new_k->param(i - j));
+                    new_k->param(i - j)->debug() = k->param(i)->debug_history();
+                }
+            }
+            if (!k->filter().empty())
+                new_k->set_filter(k->filter().cut(dead));
+            new_k->jump(k->callee(), k->args(), k->jump_debug());
+            k->destroy_body();
+            new_rets[k] = new_k;
+        }
+
+        for (auto use : ocontinuation->copy_uses()) {
+            auto caller = use->as_continuation();
+            Array<const Def*> args(caller->args());
+            args[index] = args[index] == ret ? new_ret : new_rets[args[index]];
+            caller->jump(ncontinuation, args, caller->jump_debug());
+        }
+
+        ++num_returns_;
+        return true;
+    }
+
+    /**
+     * Is @p param a pointer to a scalar that is only loaded from with the @p mem of its @p Continuation?
+     * Note that this includes loads in branch targets which use @p mem as a free variable - see @p promote.
+     */
+    static bool is_promotable(const Param* param, const Param* mem) {
+        auto ptr = param->type()->isa<PtrType>();
+        if (ptr == nullptr || ptr->is_vector() || param->num_uses() == 0)
+            return false;
+        auto pointee = ptr->pointee();
+        if (!(pointee->isa<PrimType>() && !pointee->as<PrimType>()->is_vector()) && !pointee->isa<PtrType>())
+            return false;
+        for (auto use : param->uses()) {
+            if (use->is_replaced())
+                continue; // garbage
+            auto load = use->isa<Load>();
+            if (load == nullptr || use.index() != 1 || load->mem() != mem)
+                return false;
+        }
+        return true;
+    }
+
+    /// Are all loads from @p param scheduled in the entry block - so that they run on each call?
+    static bool is_loaded_on_entry(const Param* param, const Schedule& schedule) {
+        const auto& entry = schedule[schedule.cfg().entry()];
+        for (auto use : param->uses()) {
+            if (!use->is_replaced() && std::find(entry.begin(), entry.end(), use.def()) == entry.end())
+                return false;
+        }
+        return true;
+    }
+
+    /**
+     * Argument promotion:
+     * Pointer params that are only loaded from with the memory of the entry are passed by value.
+     * The callers perform the load right before the call - on the very same memory.
+     * The callee may guard a load, e.g. by a null check, so the loads must be executed on each call anyway.
+     */
+    bool promote(Continuation* ocontinuation) {
+        auto mem = ocontinuation->mem_param();
+        if (mem == nullptr)
+            return false;
+
+        std::vector<size_t> promoted;
+        for (auto param : ocontinuation->params()) {
+            if (is_promotable(param, mem))
+                promoted.push_back(param->index());
+        }
+        if (promoted.empty())
+            return false;
+
+        {
+            Scope scope(ocontinuation);
+            auto schedule = thorin::schedule(scope);
+            promoted.erase(std::remove_if(promoted.begin(), promoted.end(), [&] (size_t i) {
+                return !is_loaded_on_entry(ocontinuation->param(i), schedule);
+            }), promoted.end());
+        }
+        if (promoted.empty())
+            return false;
+
+        DLOG("passing {} pointer params of {} by value", promoted.size(), ocontinuation);
+        Array<const Type*> types(ocontinuation->type()->ops());
+        for (auto i : promoted)
+            types[i] = types[i]->as<PtrType>()->pointee();
+        auto ncontinuation = rebuild(ocontinuation, world().fn_type(types), promoted);
+        for (auto i : promoted) {
+            for (auto use : ocontinuation->param(i)->copy_uses()) {
+                if (!use->is_replaced())
+                    use->replace(world().tuple({ncontinuation->mem_param(), ncontinuation->param(i)}, use->debug()));
+            }
+        }
+        ncontinuation->jump(ocontinuation->callee(), ocontinuation->args(), ocontinuation->jump_debug());
+        ocontinuation->destroy_body();
+
+        for (auto use : ocontinuation->copy_uses()) {
+            auto caller = use->as_continuation();
+            Array<const Def*> args(caller->args());
+            auto new_mem = args[mem->index()];
+            for (auto i : promoted) {
+                auto load = world().load(new_mem, args[i], args[i]->debug());
+                new_mem = world().extract(load, 0_u32);
+                args[i] = world().extract(load, 1_u32);
+            }
+            args[mem->index()] = new_mem;
+            caller->jump(ncontinuation, args, caller->jump_debug());
+        }
+
+        num_promoted_ += promoted.size();
+        return true;
+    }
+
+    World& world_;
+    size_t num_returns_ = 0;
+    size_t num_promoted_ = 0;
+};
+
+void optimize_params(World& world) {
+    OptimizeParams optimize(world);
+    optimize.run();
+    VLOG("removed dead return values of {} functions, promoted {} pointer params", optimize.num_returns(), optimize.num_promoted());
+}
+
+}
@@ -0,0 +1,17 @@
+#ifndef THORIN_TRANSFORM_OPTIMIZE_PARAMS_H
+#define THORIN_TRANSFORM_OPTIMIZE_PARAMS_H
+
+namespace thorin {
+
+class World;
+
+/**
+ * Interprocedural optimization of the signatures of internal functions whose calls are all known:
+ * - Values passed to the return continuation that no caller uses are removed from its type.
+ * - Pointer params that are only loaded from on entry are passed by value - the callers load them instead.
+ */
+void optimize_params(World&);
+
+}
+
+#endif
@@ -3,9 +3,13 @@
 #include "thorin/transform/mangle.h"
 #include "thorin/util/hash.h"
 #include "thorin/util/log.h"
+#include "thorin/util/statistic.h"
 
 namespace thorin {
 
+THORIN_STATISTIC(num_drops,  "partial_evaluation", "specializations created by drop");
+THORIN_STATISTIC(num_folded, "partial_evaluation", "calls redirected to a specialization");
+
 class PartialEvaluator {
 public:
     PartialEvaluator(World& world, bool lower2cff)
@@ -185,10 +189,12 @@ bool PartialEvaluator::run() {
                     // create new specialization if not found in cache
                     if (p.second) {
                         target = drop(call);
+                        ++num_drops;
                         todo = true;
                     }
 
                     jump_to_dropped_call(continuation, target, call);
+                    ++num_folded;
 
                     if (lower2cff_ && fold) {
                         // re-examine next iteration:
@@ -0,0 +1,158 @@
+#include "thorin/transform/pass_manager.h"
+
+#include <sstream>
+
+#include "thorin/world.h"
+#include "thorin/transform/aos_to_soa.h"
+#include "thorin/transform/cleanup_world.h"
+#include "thorin/transform/clone_bodies.h"
+#include "thorin/transform/closure_conversion.h"
+#include "thorin/transform/codegen_prepare.h"
+#include "thorin/transform/dead_load_opt.h"
+#include "thorin/transform/dead_store_opt.h"
+#include "thorin/transform/defunctionalize.h"
+#include "thorin/transform/flatten_tuples.h"
+#include "thorin/transform/forward_loads.h"
+#include "thorin/transform/hoist_allocs.h"
+#include "thorin/transform/hoist_enters.h"
+#include "thorin/transform/hoist_loads.h"
+#include "thorin/transform/induction_vars.h"
+#include "thorin/transform/inliner.h"
+#include "thorin/transform/lift_builtins.h"
+#include "thorin/transform/merge_functions.h"
+#include "thorin/transform/optimize_params.h"
+#include "thorin/transform/partial_evaluation.h"
+#include "thorin/transform/resolve_loads.h"
+#include "thorin/transform/rewrite_flow_graphs.h"
+#include "thorin/transform/slp_vectorize.h"
+#include "thorin/transform/split_slots.h"
+#include "thorin/transform/unroll_loops.h"
+#include "thorin/util/log.h"
+#include "thorin/util/pass_report.h"
+#include "thorin/util/trace.h"
+
+namespace thorin {
+
+typedef PassManager::Pass Pass;
+
+static Pass pass(const char* name, std::function<void(World&)> run, unsigned required = PassManager::CFF,
+                 unsigned preserved = PassManager::CFF, unsigned established = 0) {
+    Pass result;
+    result.name        = name;
+    result.run         = run;
+    result.required    = required;
+    result.preserved   = preserved;
+    result.established = established;
+    return result;
+}
+
+const std::vector<Pass>& PassManager::registered() {
+    static const std::vector<Pass> passes = {
+        pass("cleanup",                 cleanup_world,                                      0, CFF, Clean),
+        pass("lower2cff",               [] (World& world) { while (partial_evaluation(world, true)); }, Clean, 0, CFF),
+        pass("partial_evaluation",      [] (World& world) { partial_evaluation(world); },   Clean, 0),
+        pass("flatten_tuples",          flatten_tuples),
+        pass("clone_bodies",            clone_bodies),
+        pass("aos_to_soa",              aos_to_soa),
+        pass("split_slots",             split_slots),
+        pass("closure_conversion",      closure_conversion),
+        pass("defunctionalize",         defunctionalize),
+        pass("lift_builtins",           lift_builtins),
+        pass("inliner",                 [] (World& world) { inliner(world); }),
+        pass("optimize_params",         optimize_params),
+        pass("merge_functions",         merge_functions),
+        pass("hoist_allocs",            hoist_allocs),
+        pass("hoist_enters",            hoist_enters),
+        pass("unroll_loops",            [] (World& world) { unroll_loops(world); }),
+        pass("forward_loads",           forward_loads),
+        pass("resolve_loads",           [] (World& world) { resolve_loads(world); }),
+        pass("hoist_loads",             hoist_loads),
+        pass("simplify_induction_vars", simplify_induction_vars),
+        pass("dead_load_opt",           dead_load_opt),
+        pass("dead_store_opt",          dead_store_opt),
+        pass("slp_vectorize",           [] (World& world) { slp_vectorize(world); }),
+        pass("rewrite_flow_graphs",     rewrite_flow_graphs,                                Clean | CFF),
+        pass("codegen_prepare",         codegen_prepare),
+    };
+    return passes;
+}
+
+const Pass* PassManager::find(const std::string& name) {
+    for (const auto& pass : registered()) {
+        if (pass.name == name)
+            return &pass;
+    }
+    return nullptr;
+}
+
+PassManager& PassManager::add(const std::string& name) {
+    auto pass = find(name);
+    if (pass == nullptr)
+        ELOG("unknown pass '{}'", name);
+    return add(*pass);
+}
+
+PassManager& PassManager::add_pipeline(const std::string& pipeline) {
+    std::istringstream is(pipeline);
+    std::string name;
+    while (std::getline(is, name, ',')) {
+        if (!name.empty())
+            add(name);
+    }
+    return *this;
+}
+
+PassManager& PassManager::add_level(int level) {
+    add("lower2cff");
+    if (level >= 1)
+        add("flatten_tuples");
+    add("clone_bodies");
+    if (level >= 3 && world().soa())
+        add("aos_to_soa");
+    if (level >= 1)
+        add("split_slots");
+    add("closure_conversion");
+    if (level >= 3)
+        add("defunctionalize");
+    add("lift_builtins");
+    if (level >= 1)
+        add("inliner");
+    if (level >= 3)
+        add_pipeline("optimize_params,merge_functions,hoist_allocs");
+    if (level >= 1)
+        add("hoist_enters");
+    if (level >= 3) {
+        add(pass("unroll_loops", [] (World& world) { unroll_loops(world, 4); }));
+        add_pipeline("forward_loads,hoist_loads,simplify_induction_vars");
+    }
+    if (level >= 1)
+        add("dead_load_opt");
+    if (level >= 3)
+        add("dead_store_opt");
+    return add_pipeline("rewrite_flow_graphs,codegen_prepare");
+}
+
+void PassManager::establish(unsigned properties) {
+    if ((properties & CFF) && !(valid_ & CFF))
+        run(*find("lower2cff"));
+    if ((properties & Clean) && !(valid_ & Clean))
+        run(*find("cleanup"));
+}
+
+void PassManager::run(const Pass& pass) {
+    establish(pass.required);
+    VLOG("running pass {}", pass.name);
+    PassReport::Measure measure(world(), pass.name);
+    Trace::Span span("pass");
+    if (span)
+        span.name(pass.name);
+    pass.run(world());
+    valid_ = (valid_ & pass.preserved) | pass.established;
+}
+
+void PassManager::run() {
+    for (const auto& pass : passes_)
+        run(pass);
+}
+
+}
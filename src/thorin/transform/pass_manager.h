@@ -0,0 +1,76 @@
+#ifndef THORIN_TRANSFORM_PASS_MANAGER_H
+#define THORIN_TRANSFORM_PASS_MANAGER_H
+
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace thorin {
+
+class World;
+
+/**
+ * Runs a pipeline of named passes on a @p World.
+ * Each @p Pass declares the @p Property%s of the @p World it requires and the ones it preserves.
+ * Before a pass runs, the @p PassManager establishes the required ones that have been invalidated by running @p cleanup
+ * or lower2cff in between.
+ */
+class PassManager {
+public:
+    enum Property : unsigned {
+        Clean = 1 << 0, ///< No garbage is left and no @p PrimOp is outdated - see @p World::cleanup.
+        CFF   = 1 << 1, ///< The @p World is in control flow form - see @p partial_evaluation.
+    };
+
+    struct Pass {
+        std::string name;
+        std::function<void(World&)> run;
+        unsigned required    = 0; ///< @p Property%s that must be valid before the pass runs
+        unsigned preserved   = 0; ///< @p Property%s that stay valid if they were before
+        unsigned established = 0; ///< @p Property%s that are valid afterwards
+    };
+
+    PassManager(World& world)
+        : world_(world)
+    {}
+
+    World& world() const { return world_; }
+    const std::vector<Pass>& passes() const { return passes_; }
+
+    /// Appends the registered pass called @p name - see @p registered.
+    PassManager& add(const std::string& name);
+    PassManager& add(Pass pass) { passes_.push_back(std::move(pass)); return *this; }
+    /// Appends a comma-separated list of registered passes like <tt>"inliner,hoist_enters"</tt>.
+    PassManager& add_pipeline(const std::string& pipeline);
+    /**
+     * Appends the pipeline of optimization level @p level:
+     * - 0: only what code generation needs
+     * - 1: additionally the cheap local optimizations
+     * - 2: all optimizations that are safe to run by default - this is @p World::opt
+     * - 3: additionally the newer loop, memory and interprocedural optimizations which still lack test coverage:
+     *   @p defunctionalize, @p optimize_params, @p merge_functions, @p hoist_allocs, @p unroll_loops (partially),
+     *   @p forward_loads, @p hoist_loads, @p simplify_induction_vars, @p dead_store_opt and - if enabled - @p aos_to_soa
+     *
+     * @p slp_vectorize is not part of any level as only the LLVM backend can emit its vector types -
+     * drivers targeting LLVM may <tt>add("slp_vectorize")</tt>.
+     */
+    PassManager& add_level(int level);
+    void run();
+
+    static const std::vector<Pass>& registered();
+    /// The registered pass called @p name - @c nullptr if there is none.
+    static const Pass* find(const std::string& name);
+
+private:
+    /// Runs @p cleanup and lower2cff as needed to make @p properties valid.
+    void establish(unsigned properties);
+    void run(const Pass&);
+
+    World& world_;
+    std::vector<Pass> passes_;
+    unsigned valid_ = 0;
+};
+
+}
+
+#endif
@@ -1,11 +1,19 @@
 #include "thorin/analyses/scope.h"
 #include "thorin/analyses/schedule.h"
 #include "thorin/world.h"
+#include "thorin/util/persistent_map.h"
+#include "thorin/util/statistic.h"
 
 namespace thorin {
 
+THORIN_STATISTIC(num_loads,  "resolve_loads", "loads replaced by the stored value");
+THORIN_STATISTIC(num_stores, "resolve_loads", "dead stores removed");
+
 class ResolveLoads {
 public:
+    /// Maps each slot to its current value - forks at memory splits are O(1).
+    typedef PersistentMap<const Def*, const Def*, GIDHash<const Def*>> SlotValues;
+
     ResolveLoads(World& world)
         : world_(world)
     {}
@@ -18,19 +26,32 @@ public:
         return todo_;
     }
 
+    bool resolve_loads(ScopeCache& cache, size_t epoch) {
+        todo_ = false;
+        Scope::for_each(world_, cache, epoch, [&] (const Scope& scope) {
+            resolve_loads(scope);
+        });
+        return todo_;
+    }
+
     void resolve_loads(const Scope& scope) {
         for (auto node : scope.f_cfg().reverse_post_order()) {
             auto continuation = node->continuation();
             for (auto param : continuation->params()) {
                 if (param->type()->isa<MemType>()) {
-                    Def2Def mapping;
+                    SlotValues mapping;
                     resolve_loads(param, mapping);
                 }
             }
         }
+
+        for (auto store : dead_stores_)
+            store->replace(store->mem());
+        num_stores += dead_stores_.size();
+        dead_stores_.clear();
     }
 
-    void resolve_loads(const Def* mem, Def2Def& mapping) {
+    void resolve_loads(const Def* mem, SlotValues& mapping) {
         // Traverse the tree of memory objects and
         // incrementally build the contents of each
         // safe slot/immutable global
@@ -43,7 +64,7 @@ public:
                 if (i == n - 1) {
                     mem = process_use(*it, mapping);
                 } else {
-                    Def2Def split_mapping = mapping;
+                    SlotValues split_mapping = mapping;
                     auto next_mem = process_use(*it, split_mapping);
                     resolve_loads(next_mem, split_mapping);
                 }
@@ -53,8 +74,10 @@ public:
         }
     }
 
-    const Def* process_use(const Def* mem_use, Def2Def& mapping) {
+    const Def* process_use(const Def* mem_use, SlotValues& mapping) {
         if (auto load = mem_use->isa<Load>()) {
+            // Fetch the out mem before the load is replaced - otherwise the traversal would stop here
+            auto out_mem = load->out_mem();
             // Try to find the slot corresponding to this load
             auto slot = find_slot(load->ptr());
             if (slot) {
@@ -65,20 +88,23 @@ public:
                 if (!contains_top(load_value)) {
                     todo_ = true;
                     load->replace(world_.tuple({ load->mem(), load_value }));
+                    ++num_loads;
                 }
             }
-            return load->out_mem();
+            return out_mem;
         } else if (auto store = mem_use->isa<Store>()) {
             // Try to find the slot corresponding to this store
             auto slot = find_slot(store->ptr());
             if (slot) {
                 if (only_stores(slot)) {
-                    store->replace(store->mem());
+                    // The traversal continues through the store - it is removed afterwards
+                    todo_ = true;
+                    dead_stores_.push_back(store);
                 } else {
                     // If the slot has been found and is safe, try to find a value for it
                     auto slot_value = get_value(slot, mapping);
                     auto stored_value = insert_to_slot(store->ptr(), slot_value, store->val(), store->debug());
-                    mapping[slot] = stored_value;
+                    mapping.set(slot, stored_value);
                 }
             }
             return store->out_mem();
@@ -88,7 +114,7 @@ public:
             for (auto use : frame->uses()) {
                 // All the slots allocated at that point contain bottom
                 assert(use->isa<Slot>());
-                mapping[use.def()] = world_.bottom(use->type()->as<PtrType>()->pointee());
+                mapping.set(use.def(), world_.bottom(use->type()->as<PtrType>()->pointee()));
             }
             return enter->out_mem();
         } else {
@@ -96,17 +122,20 @@ public:
         }
     }
 
-    const Def* get_value(const Def* alloc, Def2Def& mapping) {
-        auto it = mapping.find(alloc);
-        if (it != mapping.end())
-            return it->second;
+    const Def* get_value(const Def* alloc, SlotValues& mapping) {
+        if (auto value = mapping.find(alloc))
+            return *value;
+        const Def* value = nullptr;
         if (auto global = alloc->isa<Global>()) {
             // Immutable globals will remain set to their initial value
             if (!global->is_mutable())
-                return mapping[alloc] = global->init();
+                value = global->init();
         }
         // Nothing is known about this allocation yet
-        return mapping[alloc] = world_.top(alloc->type()->as<PtrType>()->pointee(), alloc->debug());
+        if (value == nullptr)
+            value = world_.top(alloc->type()->as<PtrType>()->pointee(), alloc->debug());
+        mapping.set(alloc, value);
+        return value;
     }
 
     const Def* extract_from_slot(const Def* ptr, const Def* slot_value, Debug dbg) {
@@ -263,10 +292,15 @@ public: \
 private:
     bool todo_;
     World& world_;
+    std::vector<const Store*> dead_stores_;
 };
 
 bool resolve_loads(World& world) {
     return ResolveLoads(world).resolve_loads();
 }
 
+bool resolve_loads(World& world, ScopeCache& cache, size_t epoch) {
+    return ResolveLoads(world).resolve_loads(cache, epoch);
+}
+
 } // namespace thorin
@@ -1,11 +1,16 @@
 #ifndef THORIN_TRANSFORM_RESOLVE_LOADS_H
 #define THORIN_TRANSFORM_RESOLVE_LOADS_H
 
+#include <cstddef>
+
 namespace thorin {
 
+class ScopeCache;
 class World;
 
 bool resolve_loads(World&);
+/// Only looks at top-level @p Scope%s that have been modified after @p epoch - see @p Scope::for_each.
+bool resolve_loads(World&, ScopeCache&, size_t epoch);
 
 }
 
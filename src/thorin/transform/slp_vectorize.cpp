@@ -0,0 +1,294 @@
+#include "thorin/primop.h"
+#include "thorin/world.h"
+#include "thorin/analyses/scope.h"
+#include "thorin/transform/slp_vectorize.h"
+#include "thorin/util/log.h"
+
+namespace thorin {
+
+class SLPVectorizer {
+public:
+    /// Stop packing operands beyond this depth.
+    static const int max_depth = 8;
+
+    SLPVectorizer(World& world, size_t width)
+        : world_(world)
+        , width_(width)
+    {}
+
+    World& world() const { return world_; }
+
+    size_t run(const Scope& scope) {
+        std::vector<const Store*> starts;
+        for (auto def : scope.defs()) {
+            if (auto store = def->isa<Store>()) {
+                if (!store->mem()->isa<Store>() || next_store(store->mem()) != store)
+                    starts.push_back(store);
+            }
+        }
+
+        size_t num = 0;
+        for (auto start : starts) {
+            std::vector<const Store*> chain;
+            for (auto store = start; store != nullptr; store = next_store(store))
+                chain.push_back(store);
+
+            for (size_t i = 0; i + width_ <= chain.size();) {
+                if (vectorize(ArrayRef<const Store*>(chain).skip_front(i).get_front(width_))) {
+                    ++num;
+                    i += width_;
+                } else {
+                    ++i;
+                }
+            }
+        }
+        return num;
+    }
+
+private:
+    struct Address {
+        const Def* base = nullptr;  ///< the array that is indexed
+        const Def* index = nullptr; ///< the non-constant part of the index - @c nullptr if the index is constant
+        u64 offset = 0;             ///< the constant part of the index
+    };
+
+    /// If @p def is only used by a @p Store, return this @p Store.
+    static const Store* next_store(const Def* def) {
+        if (def->num_uses() == 1) {
+            auto use = *def->uses().begin();
+            if (use.index() == 0)
+                return use->isa<Store>();
+        }
+        return nullptr;
+    }
+
+    /// Splits @p ptr into array, variable index and constant offset - if @p ptr points to a scalar array element.
+    static bool address(const Def* ptr, Address& address) {
+        auto lea = ptr->isa<LEA>();
+        if (lea == nullptr || !lea->ptr_pointee()->isa<ArrayType>())
+            return false;
+        auto type = lea->type()->pointee()->isa<PrimType>();
+        if (type == nullptr || type->is_vector() || type->primtype_tag() == PrimType_bool)
+            return false;
+
+        address.base = lea->ptr();
+        address.index = lea->index();
+        address.offset = 0;
+        if (auto lit = lea->index()->isa<PrimLit>()) {
+            address.index = nullptr;
+            address.offset = primlit_value<u64>(lit);
+        } else if (auto add = lea->index()->isa<ArithOp>()) {
+            if (add->arithop_tag() == ArithOp_add) {
+                if (auto lit = add->lhs()->isa<PrimLit>()) {
+                    address.index = add->rhs();
+                    address.offset = primlit_value<u64>(lit);
+                } else if (auto lit = add->rhs()->isa<PrimLit>()) {
+                    address.index = add->lhs();
+                    address.offset = primlit_value<u64>(lit);
+                }
+            }
+        }
+        return true;
+    }
+
+    /// Do the pointers @p ptrs address consecutive elements of the same array in this order?
+    static bool is_consecutive(ArrayRef<const Def*> ptrs) {
+        Address first;
+        if (!address(ptrs.front(), first))
+            return false;
+
+        for (size_t i = 1, e = ptrs.size(); i != e; ++i) {
+            Address cur;
+            if (!address(ptrs[i], cur) || cur.base != first.base || cur.index != first.index || cur.offset != first.offset + i
+                    || ptrs[i]->type() != ptrs.front()->type())
+                return false;
+        }
+        return true;
+    }
+
+    /// Casts @p ptr to a pointer to a vector of the pointee.
+    const Def* vector_ptr(const Def* ptr) {
+        auto ptr_type = ptr->type()->as<PtrType>();
+        auto elem_type = ptr_type->pointee()->as<PrimType>();
+        auto vector_type = world().type(elem_type->primtype_tag(), width_);
+        return world().bitcast(world().ptr_type(vector_type, 1, ptr_type->device(), ptr_type->addr_space()), ptr, ptr->debug());
+    }
+
+    bool vectorize(ArrayRef<const Store*> stores) {
+        Array<const Def*> ptrs(stores.size()), vals(stores.size());
+        for (size_t i = 0, e = stores.size(); i != e; ++i) {
+            ptrs[i] = stores[i]->ptr();
+            vals[i] = stores[i]->val();
+        }
+
+        if (!is_consecutive(ptrs))
+            return false;
+
+        loads_.clear();
+        auto val = pack(vals, 0);
+        if (val == nullptr)
+            return false;
+
+        // commit the packed loads: the vector load takes the place of the first scalar load in the mem chain
+        for (const auto& p : loads_) {
+            auto vload = p.first;
+            const auto& loads = p.second;
+            auto vval = world().extract(vload, 1_u32);
+            for (size_t i = 0, e = loads.size(); i != e; ++i) {
+                auto mem = i == 0 ? world().extract(vload, 0_u32) : loads[i]->mem();
+                loads[i]->replace(world().tuple({ mem, world().extract(vval, u32(i), loads[i]->debug()) }));
+            }
+        }
+
+        auto front = stores.front(), back = stores.back();
+        DLOG("vectorizing {} stores starting at {}", stores.size(), front);
+        back->replace(world().store(front->mem(), vector_ptr(front->ptr()), val, front->debug()));
+        return true;
+    }
+
+    /// Looks through the element @p Extract%s of @p Tuple%s which replace the @p Load%s packed by a previous group.
+    static const Def* resolve(const Def* def) {
+        while (auto extract = def->isa<Extract>()) {
+            auto tuple = extract->agg()->isa<Tuple>();
+            auto index = extract->index()->isa<PrimLit>();
+            if (tuple == nullptr || index == nullptr)
+                break;
+            def = tuple->op(primlit_value<u64>(index));
+        }
+        return def;
+    }
+
+    /// Packs the @p lanes into a single vector value - returns @c nullptr if this isn't possible.
+    const Def* pack(Defs defs, int depth) {
+        if (depth > max_depth)
+            return nullptr;
+
+        Array<const Def*> lanes(defs.size());
+        for (size_t i = 0, e = defs.size(); i != e; ++i)
+            lanes[i] = resolve(defs[i]);
+
+        auto first = lanes.front();
+        auto type = first->type()->isa<PrimType>();
+        if (type == nullptr || type->is_vector())
+            return nullptr;
+
+        // the lanes are the elements of a vector that is already there - e.g. from a previous group
+        if (auto extract = first->isa<Extract>()) {
+            auto vec = extract->agg();
+            auto vec_type = vec->type()->isa<VectorType>();
+            bool whole = vec_type && vec_type->length() == lanes.size();
+            for (size_t i = 0, e = lanes.size(); whole && i != e; ++i) {
+                auto lane = lanes[i]->isa<Extract>();
+                auto index = lane ? lane->index()->isa<PrimLit>() : nullptr;
+                whole = index && lane->agg() == vec && primlit_value<u64>(index) == i;
+            }
+            if (whole)
+                return vec;
+        }
+
+        bool same = true, literals = true;
+        for (auto lane : lanes) {
+            same &= lane == first;
+            literals &= lane->isa<PrimLit>() != nullptr;
+        }
+        if (same)
+            return world().splat(first, lanes.size());
+        if (literals)
+            return world().vector(lanes);
+
+        if (auto arithop = first->isa<ArithOp>()) {
+            Array<const Def*> lhs(lanes.size()), rhs(lanes.size());
+            for (size_t i = 0, e = lanes.size(); i != e; ++i) {
+                auto lane = lanes[i]->isa<ArithOp>();
+                if (lane == nullptr || lane->arithop_tag() != arithop->arithop_tag() || lane->type() != arithop->type())
+                    return nullptr;
+                lhs[i] = lane->lhs();
+                rhs[i] = lane->rhs();
+            }
+            auto vlhs = pack(lhs, depth + 1);
+            auto vrhs = vlhs ? pack(rhs, depth + 1) : nullptr;
+            return vrhs ? world().arithop(arithop->arithop_tag(), vlhs, vrhs, arithop->debug()) : nullptr;
+        }
+
+        // a vector of bools can't be stored - it's only reachable as the mask of a vector Select below
+        if (auto cmp = first->isa<Cmp>()) {
+            Array<const Def*> lhs(lanes.size()), rhs(lanes.size());
+            for (size_t i = 0, e = lanes.size(); i != e; ++i) {
+                auto lane = lanes[i]->isa<Cmp>();
+                if (lane == nullptr || lane->cmp_tag() != cmp->cmp_tag() || lane->lhs()->type() != cmp->lhs()->type())
+                    return nullptr;
+                lhs[i] = lane->lhs();
+                rhs[i] = lane->rhs();
+            }
+            auto vlhs = pack(lhs, depth + 1);
+            auto vrhs = vlhs ? pack(rhs, depth + 1) : nullptr;
+            return vrhs ? world().cmp(cmp->cmp_tag(), vlhs, vrhs, cmp->debug()) : nullptr;
+        }
+
+        if (auto select = first->isa<Select>()) {
+            Array<const Def*> conds(lanes.size()), tvals(lanes.size()), fvals(lanes.size());
+            for (size_t i = 0, e = lanes.size(); i != e; ++i) {
+                auto lane = lanes[i]->isa<Select>();
+                if (lane == nullptr || lane->type() != select->type())
+                    return nullptr;
+                conds[i] = lane->cond();
+                tvals[i] = lane->tval();
+                fvals[i] = lane->fval();
+            }
+            auto vcond = pack(conds, depth + 1);
+            auto vtval = vcond ? pack(tvals, depth + 1) : nullptr;
+            auto vfval = vtval ? pack(fvals, depth + 1) : nullptr;
+            return vfval ? world().select(vcond, vtval, vfval, select->debug()) : nullptr;
+        }
+
+        if (Load::is_out_val(first))
+            return pack_loads(lanes);
+
+        return nullptr;
+    }
+
+    /**
+     * The @p lanes must be loaded from consecutive addresses by a chain of @p Load%s without anything in between.
+     * The vector @p Load is only threaded into the mem chain once the whole tree could be packed.
+     */
+    const Def* pack_loads(Defs lanes) {
+        Array<const Load*> loads(lanes.size());
+        Array<const Def*> ptrs(lanes.size());
+        for (size_t i = 0, e = lanes.size(); i != e; ++i) {
+            loads[i] = Load::is_out_val(lanes[i]);
+            if (loads[i] == nullptr)
+                return nullptr;
+            ptrs[i] = loads[i]->ptr();
+            if (i != 0 && (loads[i]->mem() != loads[i-1]->out_mem() || loads[i-1]->out_mem()->num_uses() != 1))
+                return nullptr;
+        }
+
+        if (!is_consecutive(ptrs))
+            return nullptr;
+
+        for (const auto& p : loads_) {
+            for (auto load : p.second) {
+                for (auto other : loads) {
+                    if (load == other)
+                        return nullptr; // packed twice - in different lanes
+                }
+            }
+        }
+
+        auto vload = world().load(loads.front()->mem(), vector_ptr(ptrs.front()), loads.front()->debug());
+        loads_.emplace_back(vload, std::vector<const Load*>(loads.begin(), loads.end()));
+        return world().extract(vload, 1_u32);
+    }
+
+    World& world_;
+    size_t width_;
+    std::vector<std::pair<const Def*, std::vector<const Load*>>> loads_; ///< vector loads and the scalar loads they replace
+};
+
+void slp_vectorize(World& world, size_t width) {
+    size_t num = 0;
+    Scope::for_each(world, [&] (const Scope& scope) { num += SLPVectorizer(world, width).run(scope); });
+    VLOG("vectorized {} store groups", num);
+}
+
+}
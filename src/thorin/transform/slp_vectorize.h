@@ -0,0 +1,21 @@
+#ifndef THORIN_TRANSFORM_SLP_VECTORIZE_H
+#define THORIN_TRANSFORM_SLP_VECTORIZE_H
+
+#include <cstddef>
+
+namespace thorin {
+
+class World;
+
+/**
+ * Superword-level parallelism: packs groups of @p width @p Store%s to consecutive array elements into a single vector
+ * @p Store if the stored values are isomorphic trees of @p ArithOp%s, @p Select%s with @p Cmp%s as mask and @p Load%s
+ * from consecutive elements.
+ * Only the LLVM backend can emit the resulting vector types - so this pass is not part of any optimization level.
+ * Drivers targeting LLVM may run it via <tt>PassManager::add("slp_vectorize")</tt>.
+ */
+void slp_vectorize(World&, size_t width = 4);
+
+}
+
+#endif
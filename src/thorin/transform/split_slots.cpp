@@ -1,67 +1,138 @@
 #include "thorin/primop.h"
 #include "thorin/world.h"
+#include "thorin/analyses/alias.h"
 #include "thorin/analyses/scope.h"
 #include "thorin/analyses/schedule.h"
 #include "thorin/analyses/verify.h"
 #include "thorin/transform/split_slots.h"
 #include "thorin/util/log.h"
+#include "thorin/util/statistic.h"
 
 namespace thorin {
 
+THORIN_STATISTIC(num_split,    "split_slots", "slots split into their elements");
+THORIN_STATISTIC(num_promoted, "split_slots", "allocs promoted to slots");
+
+/// Arrays up to this size are also split if they are accessed through dynamic indices.
+static const u64 max_dynamic_dim = 8;
+
 struct IndexHash {
     static uint64_t hash(u32 u) { return u; }
     static bool eq(u32 a, u32 b) { return a == b; }
     static u32 sentinel() { return 0xFFFFFFFF; }
 };
 
+static size_t num_elems(const Type* type) {
+    if (auto array_type = type->isa<DefiniteArrayType>())
+        return array_type->dim();
+    return type->num_ops();
+}
+
+static const Type* elem_type(const Type* type, size_t i) {
+    if (auto array_type = type->isa<DefiniteArrayType>())
+        return array_type->elem_type();
+    return type->op(i);
+}
+
+/// Yields <tt>index == k</tt>.
+static const Def* is_index(const Def* index, u64 k, Debug dbg) {
+    auto& world = index->world();
+    return world.cmp_eq(index, world.cast(index->type(), world.literal_qu64(k, dbg), dbg), dbg);
+}
+
+/// Selects the @p index-th of the @p elems through a chain of @p Select%s.
+static const Def* select(const Def* index, Defs elems, Debug dbg) {
+    auto result = elems.back();
+    for (size_t k = elems.size() - 1; k-- != 0;)
+        result = index->world().select(is_index(index, k, dbg), elems[k], result, dbg);
+    return result;
+}
+
 static void split(const Slot* slot) {
-    auto array_type = slot->alloced_type()->as<DefiniteArrayType>();
-    auto dim = array_type->dim();
-    auto elem_type = array_type->elem_type();
+    auto type = slot->alloced_type();
+    auto dim = num_elems(type);
 
     HashMap<u32, const Def*, IndexHash> new_slots;
     auto& world = slot->world();
 
     auto elem_slot = [&] (u32 index) {
         if (!new_slots.contains(index))
-            new_slots[index] = world.slot(elem_type, slot->frame(), slot->debug());
+            new_slots[index] = world.slot(elem_type(type, index), slot->frame(), slot->debug());
         return new_slots[index];
     };
 
+    // loads all elements and returns the new mem
+    auto load_elems = [&] (const Def* in_mem, Array<const Def*>& elems, Debug dbg) {
+        for (size_t i = 0; i != dim; ++i) {
+            auto tuple = world.load(in_mem, elem_slot(i), dbg);
+            elems[i] = world.extract(tuple, 1_u32, dbg);
+            in_mem = world.extract(tuple, 0_u32, dbg);
+        }
+        return in_mem;
+    };
+
     for (auto use : slot->copy_uses()) {
         if (auto lea = use->isa<LEA>()) {
-            lea->replace(elem_slot(lea->index()->as<PrimLit>()->value().get_u32()));
+            if (is_const(lea->index())) {
+                lea->replace(elem_slot(primlit_value<u32>(lea->index())));
+                continue;
+            }
+
+            // dynamic index into a small array: all uses are loads and stores - see can_split
+            for (auto lea_use : lea->copy_uses()) {
+                if (auto load = lea_use->isa<Load>()) {
+                    Array<const Def*> elems(dim);
+                    auto out_mem = load_elems(load->mem(), elems, load->debug());
+                    auto val = select(lea->index(), elems, load->debug());
+                    load->replace(world.tuple({ out_mem, val }, load->debug()));
+                } else {
+                    auto store = lea_use->as<Store>();
+                    Array<const Def*> elems(dim);
+                    auto in_mem = load_elems(store->mem(), elems, store->debug());
+                    for (size_t i = 0; i != dim; ++i) {
+                        auto elem = world.select(is_index(lea->index(), i, store->debug()), store->val(), elems[i], store->debug());
+                        in_mem = world.store(in_mem, elem_slot(i), elem, store->debug());
+                    }
+                    store->replace(in_mem);
+                }
+            }
         } else if (auto store = use->isa<Store>()) {
-            auto in_mem = store->op(0);
-            for (size_t i = 0, e = dim; i != e; ++i) {
-                auto elem = world.extract(store->op(2), i, store->debug());
+            auto in_mem = store->mem();
+            for (size_t i = 0; i != dim; ++i) {
+                auto elem = world.extract(store->val(), i, store->debug());
                 in_mem = world.store(in_mem, elem_slot(i), elem, store->debug());
             }
             store->replace(in_mem);
         } else if (auto load = use->isa<Load>()) {
-            auto in_mem = load->op(0);
-            auto array = world.bottom(array_type, load->debug());
-            for (size_t i = 0, e = dim; i != e; ++i) {
-                auto tuple = world.load(in_mem, elem_slot(i), load->debug());
-                auto elem = world.extract(tuple, 1_u32, load->debug());
-                in_mem = world.extract(tuple, 0_u32, load->debug());
-                array = world.insert(array, i, elem, load->debug());
-            }
-            load->replace(world.tuple({ in_mem, array }, load->debug()));
+            Array<const Def*> elems(dim);
+            auto out_mem = load_elems(load->mem(), elems, load->debug());
+            auto aggregate = world.bottom(type, load->debug());
+            for (size_t i = 0; i != dim; ++i)
+                aggregate = world.insert(aggregate, i, elems[i], load->debug());
+            load->replace(world.tuple({ out_mem, aggregate }, load->debug()));
         }
     }
 }
 
 static bool can_split(const Slot* slot) {
-    if (!slot->alloced_type()->isa<DefiniteArrayType>())
+    auto type = slot->alloced_type();
+    auto array_type = type->isa<DefiniteArrayType>();
+    if (!array_type && !type->isa<TupleType>() && !type->isa<StructType>())
         return false;
 
-    // only accept LEAs with constant indices and loads and stores
+    // only accept LEAs with constant indices, loads and stores into the slot - and
+    // LEAs with dynamic indices into small arrays that are only used by loads and stores
     for (auto use : slot->uses()) {
         if (auto lea = use->isa<LEA>()) {
-            if (!is_const(lea->index()))
+            if (is_const(lea->index()))
+                continue;
+            if (!array_type || array_type->dim() == 0 || array_type->dim() > max_dynamic_dim || !array_type->elem_type()->isa<PrimType>())
                 return false;
-        } else if (!use->isa<Store>() && !use->isa<Load>()) {
+            for (auto lea_use : lea->uses()) {
+                if (!lea_use->isa<Load>() && !(lea_use->isa<Store>() && lea_use.index() == 1))
+                    return false;
+            }
+        } else if (!use->isa<Load>() && !(use->isa<Store>() && use.index() == 1)) {
             return false;
         }
     }
@@ -69,6 +140,29 @@ static bool can_split(const Slot* slot) {
     return true;
 }
 
+/// A small @p Alloc of a definite type whose pointer does not escape can live on the stack.
+static bool can_promote(const Alloc* alloc) {
+    if (!is_zero(alloc->extra()) || slot_size(alloc->alloced_type()) > max_slot_size)
+        return false;
+
+    for (auto use : alloc->uses()) {
+        auto extract = use->isa<Extract>();
+        if (extract == nullptr)
+            return false;
+        if (Alloc::is_out_ptr(extract) && !is_local(extract))
+            return false;
+    }
+
+    return true;
+}
+
+static void promote(const Alloc* alloc) {
+    auto& world = alloc->world();
+    auto enter = world.enter(alloc->mem(), alloc->debug());
+    auto slot = world.slot(alloc->alloced_type(), world.extract(enter, 1_u32, alloc->debug()), alloc->debug());
+    alloc->replace(world.tuple({ world.extract(enter, 0_u32, alloc->debug()), slot }, alloc->debug()));
+}
+
 static bool split_slots(const Scope& scope) {
     bool todo = false;
     for (const auto& block : schedule(scope, Schedule::Late)) {
@@ -76,6 +170,13 @@ static bool split_slots(const Scope& scope) {
             if (auto slot = primop->isa<Slot>()) {
                 if (can_split(slot)) {
                     split(slot);
+                    ++num_split;
+                    todo = true;
+                }
+            } else if (auto alloc = primop->isa<Alloc>()) {
+                if (can_promote(alloc)) {
+                    promote(alloc);
+                    ++num_promoted;
                     todo = true;
                 }
             }
@@ -6,7 +6,10 @@ namespace thorin {
 class World;
 
 /**
- * Tries to split @p Slot%s that are accessed through constant @p LEA%s.
+ * Scalar replacement of aggregates.
+ * Splits tuple, struct and array @p Slot%s that are accessed through constant @p LEA%s into one @p Slot per element.
+ * Small arrays that are accessed through dynamic indices are split as well - accesses become @p Select chains.
+ * Small @p Alloc%s whose pointer does not escape are turned into @p Slot%s first - see @p max_slot_size.
  */
 void split_slots(World&);
 
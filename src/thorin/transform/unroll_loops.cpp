@@ -0,0 +1,185 @@
+#include <map>
+
+#include "thorin/primop.h"
+#include "thorin/world.h"
+#include "thorin/analyses/cfg.h"
+#include "thorin/analyses/induction.h"
+#include "thorin/analyses/looptree.h"
+#include "thorin/analyses/schedule.h"
+#include "thorin/analyses/scope.h"
+#include "thorin/transform/mangle.h"
+#include "thorin/transform/unroll_loops.h"
+#include "thorin/util/log.h"
+
+namespace thorin {
+
+typedef LoopTree<true>::Head Head;
+
+class UnrollLoops {
+public:
+    UnrollLoops(const Scope& scope, size_t factor, size_t budget, ContinuationSet& done)
+        : scope_(scope)
+        , schedule_(scope, Schedule::Late)
+        , factor_(factor)
+        , budget_(budget)
+        , done_(done)
+    {}
+
+    World& world() const { return scope_.world(); }
+
+    size_t num_full() const { return num_full_; }
+    size_t num_partial() const { return num_partial_; }
+
+    /// Unrolls the innermost loop where this is possible - returns whether something changed.
+    bool run() { return run(scope_.f_cfg().looptree().root()); }
+
+private:
+    bool run(const Head* head) {
+        bool innermost = true;
+        for (const auto& child : head->children()) {
+            if (auto child_head = child->isa<Head>()) {
+                innermost = false;
+                if (run(child_head))
+                    return true;
+            }
+        }
+
+        if (head->is_root())
+            return false;
+
+        Induction induction(scope_, head);
+        if (!induction.is_valid() || done_.contains(induction.header()))
+            return false;
+
+        // the copies also contain the code after the loop that depends on the header - e.g. early exits that don't fold
+        auto size = std::max(this->size(induction), size_t(1));
+        auto cloned = std::max(Scope(induction.header()).defs().size(), size_t(1));
+        u64 count;
+        if (induction.trip_count(count, budget_ / cloned)) {
+            full(induction, count);
+            return true;
+        }
+
+        if (factor_ > 1 && innermost && size * factor_ <= budget_ && cloned * (factor_ - 1) <= budget_) {
+            partial(induction);
+            return true;
+        }
+
+        return false;
+    }
+
+    /// Number of @p Continuation%s and @p PrimOp%s within the loop.
+    size_t size(const Induction& induction) const {
+        size_t result = 0;
+        for (const auto& block : schedule_) {
+            if (induction.blocks().contains(block.continuation()))
+                result += block.primops().size() + 1;
+        }
+        return result;
+    }
+
+    /**
+     * Specializes the header for the constant arguments of each call from outside the loop - see @p drop.
+     * The branch of the header folds and the back edges of the specialized body again call the header with constants.
+     * This continues until the loop is left after @p count iterations.
+     */
+    void full(const Induction& induction, u64 count) {
+        auto header = induction.header();
+        DLOG("fully unrolling loop {} with {} iterations", header, count);
+
+        Scope scope(header);
+        std::map<std::vector<const Def*>, Continuation*> dropped;
+        std::vector<Continuation*> todo(induction.entries());
+        while (!todo.empty()) {
+            auto caller = todo.back();
+            todo.pop_back();
+
+            std::vector<const Def*> args(header->num_params());
+            std::vector<const Def*> rest;
+            for (size_t i = 0, e = header->num_params(); i != e; ++i) {
+                if (caller->arg(i)->isa<PrimLit>())
+                    args[i] = caller->arg(i);
+                else
+                    rest.push_back(caller->arg(i));
+            }
+
+            auto& target = dropped[args];
+            if (target == nullptr) {
+                if (dropped.size() > count + 1)
+                    continue; // leave the remaining iterations to the loop
+                Mangler mangler(scope, args, Defs());
+                target = mangler.mangle();
+                for (auto latch : induction.latches()) {
+                    if (auto new_latch = mangler.def2def(latch)) {
+                        if (new_latch->as_continuation()->callee() == header)
+                            todo.push_back(new_latch->as_continuation());
+                    }
+                }
+            }
+
+            caller->jump(target, rest, caller->jump_debug());
+        }
+
+        done_.insert(header);
+        ++num_full_;
+    }
+
+    /**
+     * Chains @c factor copies of the loop: the back edges of each copy call the next one.
+     * Each copy keeps its exit test so the trip count needn't be known.
+     */
+    void partial(const Induction& induction) {
+        auto header = induction.header();
+        DLOG("unrolling loop {} {} times", header, factor_);
+
+        Scope scope(header);
+        std::vector<Continuation*> copies(1, header);
+        std::vector<std::vector<Continuation*>> latches(1, induction.latches());
+        Array<const Def*> args(header->num_params()); // clone
+        for (size_t k = 1; k != factor_; ++k) {
+            Mangler mangler(scope, args, Defs());
+            copies.push_back(mangler.mangle());
+            latches.emplace_back();
+            for (auto latch : induction.latches()) {
+                if (auto new_latch = mangler.def2def(latch))
+                    latches.back().push_back(new_latch->as_continuation());
+            }
+        }
+
+        for (size_t k = 0; k != factor_; ++k) {
+            for (auto latch : latches[k])
+                latch->update_callee(copies[(k + 1) % factor_]);
+            done_.insert(copies[k]);
+        }
+        ++num_partial_;
+    }
+
+    const Scope& scope_;
+    Schedule schedule_;
+    size_t factor_;
+    size_t budget_;
+    ContinuationSet& done_; ///< headers of loops we already unrolled
+    size_t num_full_ = 0;
+    size_t num_partial_ = 0;
+};
+
+void unroll_loops(World& world, size_t factor, size_t budget) {
+    ContinuationSet done;
+    size_t num_full = 0, num_partial = 0;
+    bool todo = true;
+    while (todo) {
+        todo = false;
+        Scope::for_each(world, [&] (const Scope& scope) {
+            UnrollLoops unroll(scope, factor, budget, done);
+            todo |= unroll.run();
+            num_full += unroll.num_full();
+            num_partial += unroll.num_partial();
+        });
+    }
+
+    VLOG("fully unrolled {} loops, partially unrolled {} loops", num_full, num_partial);
+    if (num_full + num_partial != 0)
+        world.cleanup();
+}
+
+}
@@ -0,0 +1,20 @@
+#ifndef THORIN_TRANSFORM_UNROLL_LOOPS_H
+#define THORIN_TRANSFORM_UNROLL_LOOPS_H
+
+#include <cstddef>
+
+namespace thorin {
+
+class World;
+
+/**
+ * Loop unrolling on top of @p drop.
+ * Loops with a constant trip count are fully unrolled if the result has at most @p budget @p PrimOp%s and
+ * @p Continuation%s per loop - including the exits which are cloned along with each iteration.
+ * Other innermost loops are unrolled @p factor times within the same budget - each copy keeps its exit test.
+ */
+void unroll_loops(World&, size_t factor = 1, size_t budget = 256);
+
+}
+
+#endif
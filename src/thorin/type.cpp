@@ -2,6 +2,7 @@
 
 #include <algorithm>
 #include <iostream>
+#include <queue>
 #include <sstream>
 #include <stack>
 
@@ -215,6 +216,41 @@ const Type* TypeTable::app(const Type* callee, const Type* op) {
     return app;
 }
 
+void TypeTable::sweep(thorin::TypeSet live) {
+    std::queue<const Type*> queue;
+    for (auto type : live)
+        queue.push(type);
+
+    auto enqueue = [&](const Type* type) {
+        if (type != nullptr && live.emplace(type).second)
+            queue.push(type);
+    };
+
+    enqueue(unit_);
+    enqueue(fn0_);
+    enqueue(mem_);
+    enqueue(frame_);
+    for (auto primtype : primtypes_)
+        enqueue(primtype);
+
+    while (!queue.empty()) {
+        auto type = pop(queue);
+        for (auto op : type->ops())
+            enqueue(op);
+        if (auto app = type->isa<App>())
+            enqueue(app->cache_);
+    }
+
+    TypeSet types(types_.capacity());
+    for (auto type : types_) {
+        if (live.contains(type))
+            types.insert(type);
+        else
+            delete type;
+    }
+    swap(types_, types);
+}
+
 //------------------------------------------------------------------------------
 
 }
@@ -394,6 +394,9 @@ public:
     const DefiniteArrayType*   definite_array_type(const Type* elem, u64 dim) { return unify(new DefiniteArrayType(*this, elem, dim)); }
     const IndefiniteArrayType* indefinite_array_type(const Type* elem) { return unify(new IndefiniteArrayType(*this, elem)); }
 
+    /// Deletes all @p Type%s which are neither built-in nor reachable from @p live.
+    void sweep(thorin::TypeSet live);
+
     friend void swap(TypeTable& t1, TypeTable& t2) {
         using std::swap;
         swap(t1.types_, t2.types_);
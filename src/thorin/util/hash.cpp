@@ -1,5 +1,6 @@
 #include "thorin/util/hash.h"
-#include "thorin/util/log.h"
+
+#include <iomanip>
 
 namespace thorin {
 
@@ -10,8 +11,59 @@ uint64_t hash(const char* s) {
     return seed;
 }
 
-void debug_hash() {
-    VLOG("debug with: break {}:{}", __FILE__, __LINE__);
+static HashStats::Counters hash_counters[HashStats::Num];
+
+HashStats::Counters& HashStats::counters(Category category) { return hash_counters[category]; }
+
+const char* HashStats::name(Category category) {
+    switch (category) {
+        case PrimOps: return "primops";
+        case Types:   return "types";
+        case Uses:    return "uses";
+        case GIDs:    return "gids";
+        default:      return "other";
+    }
+}
+
+void HashStats::Counters::add(size_t probe, bool hit) {
+    lookups.fetch_add(1, std::memory_order_relaxed);
+    hits.fetch_add(hit, std::memory_order_relaxed);
+    probes.fetch_add(probe, std::memory_order_relaxed);
+    auto max = max_probe.load(std::memory_order_relaxed);
+    while (probe > max && !max_probe.compare_exchange_weak(max, probe, std::memory_order_relaxed)) {}
+}
+
+void HashStats::Counters::add_rehash(double load_factor) {
+    rehashes.fetch_add(1, std::memory_order_relaxed);
+    auto sum = load.load(std::memory_order_relaxed);
+    while (!load.compare_exchange_weak(sum, sum + load_factor, std::memory_order_relaxed)) {}
+}
+
+void HashStats::Counters::reset() {
+    for (auto counter : { &lookups, &hits, &probes, &max_probe, &rehashes })
+        counter->store(0, std::memory_order_relaxed);
+    load.store(0.0, std::memory_order_relaxed);
+}
+
+void HashStats::reset() {
+    for (auto& counters : hash_counters)
+        counters.reset();
+}
+
+std::ostream& HashStats::dump(std::ostream& os) {
+    os << std::left << std::setw(10) << "table" << std::right
+       << std::setw(14) << "lookups" << std::setw(14) << "hits" << std::setw(10) << "avg probe" << std::setw(10) << "max probe"
+       << std::setw(10) << "rehashes" << std::setw(10) << "avg load" << std::endl;
+    os << std::fixed << std::setprecision(3);
+    for (size_t i = 0; i != Num; ++i) {
+        auto category = Category(i);
+        const auto& counters = hash_counters[i];
+        os << std::left << std::setw(10) << name(category) << std::right
+           << std::setw(14) << Counters::get(counters.lookups) << std::setw(14) << Counters::get(counters.hits)
+           << std::setw(10) << counters.avg_probe() << std::setw(10) << Counters::get(counters.max_probe)
+           << std::setw(10) << Counters::get(counters.rehashes) << std::setw(10) << counters.avg_load() << std::endl;
+    }
+    return os << std::defaultfloat;
 }
 
 }
@@ -3,8 +3,8 @@
 
 #include <algorithm>
 #include <array>
+#include <atomic>
 #include <cassert>
-#include <cinttypes>
 #include <cstdint>
 #include <cstring>
 #include <iostream>
@@ -19,7 +19,45 @@ namespace thorin {
 
 //------------------------------------------------------------------------------
 
-void debug_hash();
+/**
+ * Statistics of all @p HashSet%s and @p HashMap%s, grouped by the @p Category of their hash function.
+ * A hash function selects its @p Category via a static member @c category - all others count as @p Other.
+ * The statistics are only collected if thorin has been configured with @c THORIN_PROFILE.
+ * Set the environment variable @c THORIN_HASH_STATS to dump and reset them whenever a @p World is destroyed.
+ */
+class HashStats {
+public:
+    enum Category {
+        PrimOps,    ///< the @p PrimOp%s of a @p World
+        Types,      ///< the @p Type%s of a @p TypeTable
+        Uses,       ///< the @p Use%s of each @p Def
+        GIDs,       ///< tables keyed by @p Def%s or @p Type%s like @p DefMap - mostly used in analyses and transformations
+        Other,
+        Num
+    };
+
+    /// Relaxed atomics - the tables of @p World%s on different threads update the same counters.
+    struct Counters {
+        std::atomic<uint64_t> lookups { 0 };   ///< includes insertions
+        std::atomic<uint64_t> hits { 0 };      ///< lookups which found the key
+        std::atomic<uint64_t> probes { 0 };    ///< sum of the probe lengths of all lookups
+        std::atomic<uint64_t> max_probe { 0 };
+        std::atomic<uint64_t> rehashes { 0 };
+        std::atomic<double> load { 0.0 };      ///< sum of the load factors right before each rehash
+
+        static uint64_t get(const std::atomic<uint64_t>& counter) { return counter.load(std::memory_order_relaxed); }
+        double avg_probe() const { return get(lookups) == 0 ? 0.0 : double(get(probes)) / get(lookups); }
+        double avg_load() const { return get(rehashes) == 0 ? 0.0 : load.load(std::memory_order_relaxed) / get(rehashes); }
+        void add(size_t probe, bool hit);
+        void add_rehash(double load_factor);
+        void reset();
+    };
+
+    static Counters& counters(Category);
+    static const char* name(Category);
+    static void reset();
+    static std::ostream& dump(std::ostream& = std::cerr);
+};
 
 /// Magic numbers from http://www.isthe.com/chongo/tech/comp/fnv/index.html#FNV-param .
 struct FNV1 {
@@ -76,6 +114,9 @@ struct StrHash {
 
 namespace detail {
 
+template<class H> constexpr HashStats::Category hash_category(decltype(H::category)*) { return H::category; }
+template<class H> constexpr HashStats::Category hash_category(...) { return HashStats::Other; }
+
 /// Used internally for @p HashSet and @p HashMap.
 template<class Key, class T, class H, size_t StackCapacity = 4>
 class HashTable {
@@ -221,6 +262,8 @@ public:
     size_t capacity() const { return capacity_; }
     size_t size() const { return size_; }
     bool empty() const { return size() == 0; }
+    /// Bytes allocated on the heap - 0 while the elements still fit into the inline array.
+    size_t heap_bytes() const { return on_heap() ? capacity_ * sizeof(value_type) : 0; }
     //@}
 
     //@{ get begin/end iterators
@@ -330,18 +373,26 @@ public:
     //@{ find
     iterator find(const key_type& k) {
         if (on_heap()) {
-            if (empty())
+            if (empty()) {
+                profile(0, false);
                 return end();
+            }
 
-            for (size_t i = desired_pos(k); true; i = mod(i+1)) {
-                if (is_invalid(i))
+            for (size_t i = desired_pos(k), probe = 0; true; i = mod(i+1), ++probe) {
+                if (is_invalid(i)) {
+                    profile(probe, false);
                     return end();
-                if (H::eq(key(nodes_+i), k))
+                }
+                if (H::eq(key(nodes_+i), k)) {
+                    profile(probe, true);
                     return iterator(nodes_+i, this);
+                }
             }
         }
 
-        return array_find(k);
+        auto result = array_find(k);
+        profile(0, result != end());
+        return result;
     }
 
     const_iterator find(const key_type& key) const {
@@ -370,6 +421,7 @@ public:
         assert(is_power_of_2(new_capacity));
 
         auto old_capacity = capacity_;
+        profile_rehash(old_capacity);
         capacity_ = std::max(new_capacity, size_t(MinHeapCapacity));
         auto old_nodes = alloc();
         swap(old_nodes, nodes_);
@@ -387,7 +439,6 @@ public:
                             distance = cur_distance;
                             swap(nodes_[i], old);
                         }
-                        debug(i);
                     }
                 }
             }
@@ -434,14 +485,15 @@ private:
         auto& k = key(&n);
 
         auto result = end_ptr();
-        for (size_t i = desired_pos(k), distance = 0; true; i = mod(i+1), ++distance) {
+        for (size_t i = desired_pos(k), distance = 0, probe = 0; true; i = mod(i+1), ++distance, ++probe) {
             if (is_invalid(i)) {
                 ++size_;
                 swap(nodes_[i], n);
                 result = result == end_ptr() ? nodes_+i : result;
-                debug(i);
+                profile(probe, false);
                 return std::make_pair(iterator(result, this), true);
             } else if (result == end_ptr() && H::eq(key(nodes_+i), k)) {
+                profile(probe, true);
                 return std::make_pair(iterator(nodes_+i, this), false);
             } else {
                 size_t cur_distance = probe_distance(i);
@@ -455,20 +507,13 @@ private:
     }
 
 #if THORIN_ENABLE_PROFILING
-    void debug(size_t i) {
-        auto dib = probe_distance(i);
-        if (dib > 2_s*log2(capacity())) {
-            // don't use LOG here - this results in a header dependency hell
-            printf("poor hash function; element %zu has distance %zu with size/capacity: %zu/%zu\n", i, dib, size(), capacity());
-            for (size_t j = mod(i-dib); j != i; j = mod(j+1))
-                printf("elem:desired_pos:hash: %zu:%zu:%" PRIu64 "\n", j, desired_pos(key(&nodes_[j])), hash(j));
-            debug_hash();
-        }
-    }
+    static HashStats::Counters& stats() { return HashStats::counters(hash_category<H>(nullptr)); }
+    static void profile(size_t probe, bool hit) { stats().add(probe, hit); }
+    void profile_rehash(size_t old_capacity) { stats().add_rehash(double(size_) / old_capacity); }
 #else
-    void debug(size_t) {}
+    static void profile(size_t, bool) {}
+    void profile_rehash(size_t) {}
 #endif
-    uint64_t hash(size_t i) { return H::hash(key(&nodes_[i])); } ///< just for debugging
     size_t mod(size_t i) const { return i & (capacity_-1); }
     size_t desired_pos(const key_type& key) const { return mod(H::hash(key)); }
     size_t probe_distance(size_t i) { return mod(i + capacity() - desired_pos(key(nodes_+i))); }
@@ -495,6 +540,7 @@ private:
         auto p = &array_[size_];
         swap(*p, n);
         auto i = array_find(key(p));
+        profile(0, i != end());
         if (i == end()) {
             ++size_;
             return std::make_pair(iterator(p, this), true);
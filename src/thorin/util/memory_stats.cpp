@@ -0,0 +1,166 @@
+#include "thorin/util/memory_stats.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <string>
+#include <vector>
+
+#include "thorin/continuation.h"
+#include "thorin/primop.h"
+#include "thorin/type.h"
+#include "thorin/world.h"
+#include "thorin/util/symbol.h"
+
+namespace thorin {
+
+static size_t sizeof_def(const Def* def) {
+    auto tag = def->tag();
+    if (is_primtype(tag)) return sizeof(PrimLit);
+    if (is_arithop(tag))  return sizeof(ArithOp);
+    if (is_cmp(tag))      return sizeof(Cmp);
+
+    switch (tag) {
+        case Node_Continuation:    return sizeof(Continuation);
+        case Node_Param:           return sizeof(Param);
+        case Node_Top:             return sizeof(Top);
+        case Node_Bottom:          return sizeof(Bottom);
+        case Node_Alloc:           return sizeof(Alloc);
+        case Node_Load:            return sizeof(Load);
+        case Node_Store:           return sizeof(Store);
+        case Node_Enter:           return sizeof(Enter);
+        case Node_Select:          return sizeof(Select);
+        case Node_AlignOf:         return sizeof(AlignOf);
+        case Node_SizeOf:          return sizeof(SizeOf);
+        case Node_Global:          return sizeof(Global);
+        case Node_Slot:            return sizeof(Slot);
+        case Node_Cast:            return sizeof(Cast);
+        case Node_Bitcast:         return sizeof(Bitcast);
+        case Node_DefiniteArray:   return sizeof(DefiniteArray);
+        case Node_IndefiniteArray: return sizeof(IndefiniteArray);
+        case Node_Tuple:           return sizeof(Tuple);
+        case Node_Variant:         return sizeof(Variant);
+        case Node_StructAgg:       return sizeof(StructAgg);
+        case Node_Vector:          return sizeof(Vector);
+        case Node_Closure:         return sizeof(Closure);
+        case Node_Extract:         return sizeof(Extract);
+        case Node_Insert:          return sizeof(Insert);
+        case Node_LEA:             return sizeof(LEA);
+        case Node_Hlt:             return sizeof(Hlt);
+        case Node_Known:           return sizeof(Known);
+        case Node_Run:             return sizeof(Run);
+        case Node_Assembly:        return sizeof(Assembly);
+        default:                   return sizeof(PrimOp);
+    }
+}
+
+static size_t sizeof_type(const Type* type) {
+    auto tag = type->tag();
+    if (is_primtype(tag)) return sizeof(PrimType);
+
+    switch (tag) {
+        case Node_App:                 return sizeof(App);
+        case Node_DefiniteArrayType:   return sizeof(DefiniteArrayType);
+        case Node_FnType:              return sizeof(FnType);
+        case Node_ClosureType:         return sizeof(ClosureType);
+        case Node_FrameType:           return sizeof(FrameType);
+        case Node_IndefiniteArrayType: return sizeof(IndefiniteArrayType);
+        case Node_Lambda:              return sizeof(Lambda);
+        case Node_MemType:             return sizeof(MemType);
+        case Node_PtrType:             return sizeof(PtrType);
+        case Node_StructType:          return sizeof(StructType);
+        case Node_VariantType:         return sizeof(VariantType);
+        case Node_TupleType:           return sizeof(TupleType);
+        case Node_Var:                 return sizeof(Var);
+        default:                       return sizeof(Type);
+    }
+}
+
+MemoryStats::MemoryStats(const World& world) {
+    auto add_def = [&] (const Def* def) {
+        auto& node = defs_[def->tag()];
+        ++node.count;
+        node.bytes += sizeof_def(def);
+        operands_ += def->num_ops() * sizeof(const Def*);
+        uses_ += def->uses().heap_bytes();
+    };
+
+    for (auto primop : world.primops())
+        add_def(primop);
+
+    for (auto continuation : world.continuations()) {
+        add_def(continuation);
+        for (auto param : continuation->params())
+            add_def(param);
+        params_ += (continuation->num_params() + continuation->filter().size()) * sizeof(const Def*);
+    }
+
+    for (auto type : world.types()) {
+        auto& node = types_[type->tag()];
+        ++node.count;
+        node.bytes += sizeof_type(type);
+        operands_ += type->num_ops() * sizeof(const Type*);
+    }
+
+    tables_ = world.primops().heap_bytes() + world.continuations().heap_bytes()
+            + world.externals().heap_bytes() + world.types().heap_bytes();
+    symbols_ = Symbol::table_bytes();
+}
+
+size_t MemoryStats::num_defs() const {
+    size_t result = 0;
+    for (const auto& node : defs_) result += node.count;
+    return result;
+}
+
+size_t MemoryStats::num_types() const {
+    size_t result = 0;
+    for (const auto& node : types_) result += node.count;
+    return result;
+}
+
+size_t MemoryStats::def_bytes() const {
+    size_t result = 0;
+    for (const auto& node : defs_) result += node.bytes;
+    return result;
+}
+
+size_t MemoryStats::type_bytes() const {
+    size_t result = 0;
+    for (const auto& node : types_) result += node.bytes;
+    return result;
+}
+
+size_t MemoryStats::total() const {
+    return def_bytes() + type_bytes() + operands_ + uses_ + params_ + tables_;
+}
+
+std::ostream& MemoryStats::dump(std::ostream& os) const {
+    auto row = [&] (const std::string& name, const std::string& count, size_t bytes) {
+        os << std::left << std::setw(24) << name << std::right << std::setw(12) << count << std::setw(16) << bytes << std::endl;
+    };
+    auto nodes = [&] (const std::array<Node, Num_AllNodes>& array) {
+        std::vector<size_t> tags;
+        for (size_t tag = 0; tag != array.size(); ++tag) {
+            if (array[tag].count != 0)
+                tags.push_back(tag);
+        }
+        std::stable_sort(tags.begin(), tags.end(), [&] (size_t a, size_t b) { return array[a].bytes > array[b].bytes; });
+        for (auto tag : tags)
+            row(std::string("  ") + tag2str(NodeTag(tag)), std::to_string(array[tag].count), array[tag].bytes);
+    };
+
+    os << std::left << std::setw(24) << "category" << std::right << std::setw(12) << "count" << std::setw(16) << "bytes" << std::endl;
+    row("defs", std::to_string(num_defs()), def_bytes());
+    nodes(defs_);
+    row("types", std::to_string(num_types()), type_bytes());
+    nodes(types_);
+    row("operands", "", operands_);
+    row("uses", "", uses_);
+    row("params", "", params_);
+    row("tables", "", tables_);
+    row("total", "", total());
+    row("symbols (process)", std::to_string(Symbol::table_size()), symbols_);
+    return os;
+}
+
+}
@@ -0,0 +1,58 @@
+#ifndef THORIN_UTIL_MEMORY_STATS_H
+#define THORIN_UTIL_MEMORY_STATS_H
+
+#include <array>
+#include <iostream>
+
+#include "thorin/enums.h"
+
+namespace thorin {
+
+class World;
+
+/**
+ * Live bytes of a @p World broken down by category - see @p World::memory_stats.
+ * The numbers are computed from the sizes of the nodes and the capacities of their containers;
+ * they do not include the overhead of the allocator.
+ * Analyses like @p Scope, @p CFG or @p Schedule as well as temporary @p Array%s are owned by their users and not counted.
+ * Set the environment variable @c THORIN_MEMORY_STATS to print them whenever a @p World is destroyed.
+ */
+class MemoryStats {
+public:
+    struct Node {
+        size_t count = 0;
+        size_t bytes = 0; ///< size of the objects themselves - without @p operands and @p uses
+    };
+
+    explicit MemoryStats(const World&);
+
+    const Node& def(NodeTag tag) const { return defs_[tag]; }
+    const Node& type(NodeTag tag) const { return types_[tag]; }
+    size_t num_defs() const;
+    size_t num_types() const;
+    size_t def_bytes() const;
+    size_t type_bytes() const;
+    size_t operand_bytes() const { return operands_; } ///< operands of @p Def%s and @p Type%s
+    size_t use_bytes() const { return uses_; }         ///< @p Uses tables which outgrew their inline storage
+    size_t param_bytes() const { return params_; }     ///< parameter lists and filters of @p Continuation%s
+    size_t table_bytes() const { return tables_; }     ///< the @p World's sets of primops, continuations and types
+    size_t symbol_bytes() const { return symbols_; }   ///< the symbol table - shared by all @p World%s of the process
+    /// Everything but the symbol table.
+    size_t total() const;
+
+    /// Prints a table of all categories and the @p Node%s which are present.
+    std::ostream& dump(std::ostream& = std::cout) const;
+
+private:
+    std::array<Node, Num_AllNodes> defs_;
+    std::array<Node, Num_AllNodes> types_;
+    size_t operands_ = 0;
+    size_t uses_ = 0;
+    size_t params_ = 0;
+    size_t tables_ = 0;
+    size_t symbols_ = 0;
+};
+
+}
+
+#endif
@@ -0,0 +1,139 @@
+#include "thorin/util/pass_report.h"
+
+#include <algorithm>
+#include <iomanip>
+
+#include "thorin/world.h"
+#include "thorin/util/memory_stats.h"
+
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
+namespace thorin {
+
+PassReport::Measure::Measure(World& world, std::string name)
+    : world_(world)
+    , report_(world.pass_report())
+{
+    if (report_ == nullptr)
+        return;
+
+    index_ = report_->entries_.size();
+    report_->entries_.emplace_back();
+    auto& entry = report_->entries_.back();
+    entry.name = std::move(name);
+    entry.depth = report_->depth_++;
+    entry.before = counts(world);
+    entry.peak_before = peak_memory();
+    if (entry.depth == 0) // walking the World would add to the time of the enclosing entry otherwise
+        entry.live_before = world.memory_stats().total();
+    wall_ = std::chrono::steady_clock::now();
+    cpu_ = std::clock();
+}
+
+PassReport::Measure::~Measure() {
+    if (report_ == nullptr)
+        return;
+
+    auto cpu = std::clock();
+    auto wall = std::chrono::steady_clock::now();
+    auto& entry = report_->entries_[index_];
+    entry.wall = std::chrono::duration<double>(wall - wall_).count();
+    entry.cpu = double(cpu - cpu_) / CLOCKS_PER_SEC;
+    entry.after = counts(world_);
+    entry.peak_after = peak_memory();
+    if (entry.depth == 0)
+        entry.live_after = world_.memory_stats().total();
+    --report_->depth_;
+}
+
+PassReport::Counts PassReport::counts(const World& world) {
+    Counts result;
+    result.primops = world.primops().size();
+    result.continuations = world.continuations().size();
+    result.types = world.types().size();
+    return result;
+}
+
+size_t PassReport::peak_live() const {
+    size_t result = 0;
+    for (const auto& entry : entries_)
+        result = std::max(result, entry.live_after);
+    return result;
+}
+
+size_t PassReport::peak_memory() {
+#ifdef _WIN32
+    return 0;
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+        return 0;
+#ifdef __APPLE__
+    return usage.ru_maxrss;        // bytes
+#else
+    return usage.ru_maxrss * 1024; // kilobytes
+#endif
+#endif
+}
+
+std::ostream& PassReport::dump_table(std::ostream& os) const {
+    size_t width = 4;
+    for (const auto& entry : entries_)
+        width = std::max(width, 2 * entry.depth + entry.name.size());
+
+    auto count = [&] (size_t before, size_t after) {
+        os << std::setw(8) << before << " -> " << std::setw(8) << after;
+    };
+
+    os << std::left << std::setw(width) << "pass" << std::right
+       << std::setw(11) << "wall [ms]" << std::setw(11) << "cpu [ms]"
+       << std::setw(20) << "primops" << std::setw(20) << "continuations" << std::setw(20) << "types"
+       << std::setw(12) << "live [KiB]" << std::setw(12) << "peak [KiB]" << std::endl;
+
+    os << std::fixed << std::setprecision(2);
+    for (const auto& entry : entries_) {
+        os << std::left << std::setw(width) << (std::string(2 * entry.depth, ' ') + entry.name) << std::right
+           << std::setw(11) << entry.wall * 1000.0 << std::setw(11) << entry.cpu * 1000.0 << "  ";
+        count(entry.before.primops, entry.after.primops);
+        os << "  ";
+        count(entry.before.continuations, entry.after.continuations);
+        os << "  ";
+        count(entry.before.types, entry.after.types);
+        os << std::setw(12);
+        if (entry.depth == 0)
+            os << entry.live_after / 1024;
+        else
+            os << "";
+        os << std::setw(12) << entry.peak_after / 1024 << std::endl;
+    }
+    return os << std::defaultfloat;
+}
+
+std::ostream& PassReport::dump_json(std::ostream& os) const {
+    auto counts = [&] (const char* name, const Counts& counts) {
+        os << "\"" << name << "\": {\"primops\": " << counts.primops << ", \"continuations\": " << counts.continuations
+           << ", \"types\": " << counts.types << "}";
+    };
+
+    os << "[";
+    for (size_t i = 0, e = entries_.size(); i != e; ++i) {
+        const auto& entry = entries_[i];
+        os << (i == 0 ? "\n" : ",\n") << "    {\"name\": \"";
+        for (auto c : entry.name) {
+            if (c == '"' || c == '\\')
+                os << '\\';
+            os << c;
+        }
+        os << "\", \"depth\": " << entry.depth << ", \"wall\": " << entry.wall << ", \"cpu\": " << entry.cpu << ", ";
+        counts("before", entry.before);
+        os << ", ";
+        counts("after", entry.after);
+        os << ", \"live_before\": " << entry.live_before << ", \"live_after\": " << entry.live_after
+           << ", \"peak_before\": " << entry.peak_before << ", \"peak_after\": " << entry.peak_after << "}";
+    }
+    return os << "\n]" << std::endl;
+}
+
+}
@@ -0,0 +1,74 @@
+#ifndef THORIN_UTIL_PASS_REPORT_H
+#define THORIN_UTIL_PASS_REPORT_H
+
+#include <chrono>
+#include <ctime>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace thorin {
+
+class World;
+
+/**
+ * Records wall and CPU time, the number of nodes, the live bytes of the @p World and the peak memory of the process
+ * for each pass run on a @p World.
+ * Attach it with @p World::set_pass_report - the @p PassManager then measures each pass and @p cleanup each iteration
+ * of its fix point.
+ */
+class PassReport {
+public:
+    /// Number of nodes in a @p World.
+    struct Counts {
+        size_t primops = 0;
+        size_t continuations = 0;
+        size_t types = 0;
+    };
+
+    struct Entry {
+        std::string name;
+        size_t depth;        ///< nesting level - a @p cleanup iteration within a pass has depth 1
+        double wall = 0.0;   ///< seconds
+        double cpu = 0.0;    ///< seconds
+        Counts before, after;
+        size_t peak_before = 0, peak_after = 0; ///< peak resident set size of the process in bytes
+        size_t live_before = 0, live_after = 0; ///< @p MemoryStats::total of the @p World - only recorded at depth 0
+    };
+
+    /**
+     * Measures from construction to destruction and records the result as an @p Entry called @p name.
+     * Does nothing if @p world has no @p PassReport attached.
+     */
+    class Measure {
+    public:
+        Measure(World& world, std::string name);
+        ~Measure();
+
+    private:
+        World& world_;
+        PassReport* report_;
+        size_t index_;
+        std::chrono::steady_clock::time_point wall_;
+        std::clock_t cpu_;
+    };
+
+    const std::vector<Entry>& entries() const { return entries_; }
+    /// Maximum of @p Entry::live_after - the largest the @p World grew between two passes.
+    size_t peak_live() const;
+    void clear() { entries_.clear(); }
+    std::ostream& dump_table(std::ostream& = std::cout) const;
+    std::ostream& dump_json(std::ostream& = std::cout) const;
+
+    static Counts counts(const World&);
+    /// Peak resident set size of this process in bytes - 0 if unavailable on this platform.
+    static size_t peak_memory();
+
+private:
+    std::vector<Entry> entries_;
+    size_t depth_ = 0;
+};
+
+}
+
+#endif
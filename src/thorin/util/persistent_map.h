@@ -0,0 +1,124 @@
+#ifndef THORIN_UTIL_PERSISTENT_MAP_H
+#define THORIN_UTIL_PERSISTENT_MAP_H
+
+#include <bitset>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace thorin {
+
+/**
+ * A persistent map implemented as a hash array mapped trie.
+ * Copies share their structure, so copying a @p PersistentMap is O(1).
+ * @p set only copies the path from the root to the modified entry.
+ * The hash function @p H has the same interface as the one of @p HashMap.
+ */
+template<class Key, class Value, class H = typename Key::Hash>
+class PersistentMap {
+private:
+    static const int bits = 6;                ///< 64-way branching
+    static const int max_depth = 64 / bits;   ///< hash bits are exhausted - keys are kept in a linear list
+
+    struct Node;
+
+    /// Either a key/value pair or - if @p child is set - a subtree.
+    struct Entry {
+        uint64_t hash;
+        Key key;
+        Value value;
+        std::shared_ptr<const Node> child;
+    };
+
+    struct Node {
+        uint64_t bitmap = 0; ///< which of the 64 slots are occupied; @p entries is compressed accordingly
+        std::vector<Entry> entries;
+    };
+
+public:
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+
+    /// Returns a pointer to the @p Value of @p key or @c nullptr if @p key is not in this map.
+    const Value* find(const Key& key) const {
+        auto hash = H::hash(key);
+        auto node = root_.get();
+        for (int depth = 0; node != nullptr; ++depth) {
+            if (depth == max_depth) {
+                for (const auto& entry : node->entries) {
+                    if (H::eq(entry.key, key))
+                        return &entry.value;
+                }
+                return nullptr;
+            }
+
+            auto bit = uint64_t(1) << slot(hash, depth);
+            if ((node->bitmap & bit) == 0)
+                return nullptr;
+
+            const auto& entry = node->entries[position(node->bitmap, bit)];
+            if (entry.child == nullptr)
+                return H::eq(entry.key, key) ? &entry.value : nullptr;
+            node = entry.child.get();
+        }
+        return nullptr;
+    }
+
+    bool contains(const Key& key) const { return find(key) != nullptr; }
+
+    /// Maps @p key to @p value - overwriting any previous mapping of @p key.
+    void set(const Key& key, const Value& value) {
+        bool inserted = false;
+        root_ = set(root_.get(), 0, Entry{H::hash(key), key, value, nullptr}, inserted);
+        size_ += inserted ? 1 : 0;
+    }
+
+private:
+    static size_t slot(uint64_t hash, int depth) { return (hash >> uint64_t(depth * bits)) & uint64_t((1 << bits) - 1); }
+    static size_t position(uint64_t bitmap, uint64_t bit) { return std::bitset<64>(bitmap & (bit - 1)).count(); }
+
+    static std::shared_ptr<const Node> set(const Node* old_node, int depth, Entry&& leaf, bool& inserted) {
+        auto node = old_node == nullptr ? std::make_shared<Node>() : std::make_shared<Node>(*old_node);
+
+        if (depth == max_depth) {
+            for (auto& entry : node->entries) {
+                if (H::eq(entry.key, leaf.key)) {
+                    entry.value = leaf.value;
+                    return node;
+                }
+            }
+            node->entries.emplace_back(std::move(leaf));
+            inserted = true;
+            return node;
+        }
+
+        auto bit = uint64_t(1) << slot(leaf.hash, depth);
+        auto pos = position(node->bitmap, bit);
+        if ((node->bitmap & bit) == 0) {
+            node->bitmap |= bit;
+            node->entries.emplace(node->entries.begin() + pos, std::move(leaf));
+            inserted = true;
+            return node;
+        }
+
+        auto& entry = node->entries[pos];
+        if (entry.child != nullptr) {
+            entry.child = set(entry.child.get(), depth + 1, std::move(leaf), inserted);
+        } else if (H::eq(entry.key, leaf.key)) {
+            entry.value = leaf.value;
+        } else {
+            // push the old leaf one level down and insert the new one next to it
+            bool dummy = false;
+            auto child = set(nullptr, depth + 1, Entry(entry), dummy);
+            entry = Entry{0, Key(), Value(), set(child.get(), depth + 1, std::move(leaf), inserted)};
+        }
+        return node;
+    }
+
+    std::shared_ptr<const Node> root_;
+    size_t size_ = 0;
+};
+
+}
+
+#endif
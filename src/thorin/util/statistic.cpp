@@ -0,0 +1,57 @@
+#include "thorin/util/statistic.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iomanip>
+
+namespace thorin {
+
+/*
+ * A function-local static is safe to use from the constructors of other static objects.
+ * It is only modified during static initialization, so reading it concurrently is fine.
+ */
+static std::vector<Statistic*>& registry() {
+    static std::vector<Statistic*> statistics;
+    return statistics;
+}
+
+Statistic::Statistic(const char* group, const char* name, const char* desc)
+    : group_(group)
+    , name_(name)
+    , desc_(desc)
+    , value_(0)
+{
+    registry().push_back(this);
+}
+
+std::vector<const Statistic*> Statistic::all() {
+    std::vector<const Statistic*> result(registry().begin(), registry().end());
+    std::sort(result.begin(), result.end(), [] (const Statistic* a, const Statistic* b) {
+        auto cmp = std::strcmp(a->group(), b->group());
+        return cmp < 0 || (cmp == 0 && std::strcmp(a->name(), b->name()) < 0);
+    });
+    return result;
+}
+
+const Statistic* Statistic::find(const char* group, const char* name) {
+    for (auto statistic : registry()) {
+        if (std::strcmp(statistic->group(), group) == 0 && std::strcmp(statistic->name(), name) == 0)
+            return statistic;
+    }
+    return nullptr;
+}
+
+void Statistic::reset_all() {
+    for (auto statistic : registry())
+        statistic->reset();
+}
+
+std::ostream& Statistic::dump(std::ostream& os) {
+    for (auto statistic : all()) {
+        if (statistic->value() != 0)
+            os << std::setw(12) << statistic->value() << " " << statistic->group() << " - " << statistic->desc() << std::endl;
+    }
+    return os;
+}
+
+}
@@ -0,0 +1,68 @@
+#ifndef THORIN_UTIL_STATISTIC_H
+#define THORIN_UTIL_STATISTIC_H
+
+#include <atomic>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+#include "thorin/config.h"
+
+namespace thorin {
+
+/**
+ * A named counter of how often an optimization did something - similar to LLVM's @c STATISTIC.
+ * Declare one per event at namespace scope of the translation unit via @p THORIN_STATISTIC.
+ * All counters register themselves and can be read, reset and printed through the static members.
+ * Set the environment variable @c THORIN_STATS to print and reset them whenever a @p World is destroyed.
+ * The counters only exist with the CMake option @c THORIN_STATISTICS - otherwise @p THORIN_STATISTIC compiles to nothing.
+ */
+class Statistic {
+public:
+    Statistic(const Statistic&) = delete;
+    Statistic& operator=(const Statistic&) = delete;
+
+    Statistic(const char* group, const char* name, const char* desc);
+
+    const char* group() const { return group_; }
+    const char* name() const { return name_; }
+    const char* desc() const { return desc_; }
+    uint64_t value() const { return value_.load(std::memory_order_relaxed); }
+    void reset() { value_.store(0, std::memory_order_relaxed); }
+
+    Statistic& operator++() { value_.fetch_add(1, std::memory_order_relaxed); return *this; }
+    Statistic& operator+=(uint64_t n) { value_.fetch_add(n, std::memory_order_relaxed); return *this; }
+
+    /// All registered @p Statistic%s sorted by group and name.
+    static std::vector<const Statistic*> all();
+    /// The @p Statistic called @p name in @p group - @c nullptr if there is none.
+    static const Statistic* find(const char* group, const char* name);
+    static void reset_all();
+    /// Prints all @p Statistic%s which are not zero.
+    static std::ostream& dump(std::ostream& = std::cerr);
+
+private:
+    const char* group_;
+    const char* name_;
+    const char* desc_;
+    std::atomic<uint64_t> value_;
+};
+
+/// Stands in for a @p Statistic without @c THORIN_STATISTICS.
+struct NoStatistic {
+    uint64_t value() const { return 0; }
+    void reset() {}
+    NoStatistic& operator++() { return *this; }
+    NoStatistic& operator+=(uint64_t) { return *this; }
+};
+
+}
+
+/// Declares the @p Statistic @p var in @p group, e.g. <tt>THORIN_STATISTIC(num_inlined, "inliner", "call sites inlined")</tt>.
+#if THORIN_ENABLE_STATISTICS
+#define THORIN_STATISTIC(var, group, desc) static thorin::Statistic var(group, #var, desc)
+#else
+#define THORIN_STATISTIC(var, group, desc) static thorin::NoStatistic var
+#endif
+
+#endif
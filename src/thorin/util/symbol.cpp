@@ -1,5 +1,6 @@
 #include "thorin/util/symbol.h"
 
+#include <cstring>
 #include <iomanip>
 #include <sstream>
 
@@ -20,6 +21,13 @@ void Symbol::insert(const char* s) {
     str_ = *i;
 }
 
+size_t Symbol::table_bytes() {
+    size_t result = table_.map.heap_bytes();
+    for (auto s : table_.map)
+        result += std::strlen(s) + 1;
+    return result;
+}
+
 std::string Symbol::remove_quotation() const {
     std::string str = str_;
     if (!str.empty() && str.front() == '"') {
@@ -30,6 +30,11 @@ public:
     bool is_anonymous() { return (*this) == "_"; }
     std::string remove_quotation() const;
 
+    /// Number of distinct strings in the process-wide symbol table.
+    static size_t table_size() { return table_.map.size(); }
+    /// Bytes used by the process-wide symbol table including its strings.
+    static size_t table_bytes();
+
 private:
     Symbol(int /* just a dummy */)
         : str_((const char*)(1))
@@ -0,0 +1,130 @@
+#include "thorin/util/trace.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <mutex>
+
+namespace thorin {
+
+/// Shared by all threads - the file is only written while holding @c mutex.
+struct TraceState {
+    std::atomic<bool> enabled { false };
+    std::mutex mutex;
+    std::ofstream file;
+    bool first = true;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+};
+
+static TraceState& state() {
+    static TraceState state;
+    return state;
+}
+
+/// Microseconds since the process started tracing.
+static double now() {
+    return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - state().start).count();
+}
+
+/// Small, stable id for the calling thread.
+static unsigned thread_id() {
+    static std::atomic<unsigned> counter { 0 };
+    thread_local unsigned id = counter++;
+    return id;
+}
+
+static std::string escape(const std::string& str) {
+    std::string result;
+    for (auto c : str) {
+        if (c == '"' || c == '\\')
+            result += '\\';
+        if (c >= 0 && c < ' ')
+            result += ' ';
+        else
+            result += c;
+    }
+    return result;
+}
+
+/// Enables the @p Trace via @c THORIN_TRACE at startup and finishes it at exit.
+static struct EnvTrace {
+    EnvTrace() {
+        state(); // construct it first so it outlives us
+        if (auto filename = std::getenv("THORIN_TRACE"))
+            Trace::enable(filename);
+    }
+    ~EnvTrace() { Trace::disable(); }
+} env_trace;
+
+bool Trace::enable(const std::string& filename) {
+    auto& s = state();
+    std::lock_guard<std::mutex> guard(s.mutex);
+    if (s.file.is_open())
+        s.file << "\n]\n";
+    s.file.close();
+    s.file.open(filename);
+    if (!s.file)
+        return false;
+    s.file << std::fixed << std::setprecision(3) << "[";
+    s.first = true;
+    s.enabled = true;
+    return true;
+}
+
+void Trace::disable() {
+    auto& s = state();
+    std::lock_guard<std::mutex> guard(s.mutex);
+    s.enabled = false;
+    if (s.file.is_open()) {
+        s.file << "\n]\n";
+        s.file.close();
+    }
+}
+
+bool Trace::is_enabled() { return state().enabled.load(std::memory_order_relaxed); }
+
+Trace::Span::Span(const char* category, const char* name)
+    : active_(is_enabled())
+    , category_(category)
+{
+    if (active_) {
+        if (name != nullptr)
+            name_ = name;
+        start_ = now();
+    }
+}
+
+Trace::Span::~Span() {
+    if (!active_)
+        return;
+
+    auto end = now();
+    auto& s = state();
+    std::lock_guard<std::mutex> guard(s.mutex);
+    if (!s.enabled)
+        return;
+    s.file << (s.first ? "\n" : ",\n")
+           << "{\"name\": \"" << escape(name_.empty() ? category_ : name_) << "\", \"cat\": \"" << category_
+           << "\", \"ph\": \"X\", \"ts\": " << start_ << ", \"dur\": " << end - start_
+           << ", \"pid\": 1, \"tid\": " << thread_id();
+    if (!args_.empty())
+        s.file << ", \"args\": {" << args_ << "}";
+    s.file << "}";
+    s.first = false;
+}
+
+Trace::Span& Trace::Span::arg(const char* key, const std::string& value) {
+    if (active_)
+        args_ += (args_.empty() ? "\"" : ", \"") + std::string(key) + "\": \"" + escape(value) + "\"";
+    return *this;
+}
+
+Trace::Span& Trace::Span::arg(const char* key, uint64_t value) {
+    if (active_)
+        args_ += (args_.empty() ? "\"" : ", \"") + std::string(key) + "\": " + std::to_string(value);
+    return *this;
+}
+
+}
@@ -0,0 +1,51 @@
+#ifndef THORIN_UTIL_TRACE_H
+#define THORIN_UTIL_TRACE_H
+
+#include <cstdint>
+#include <string>
+
+namespace thorin {
+
+/**
+ * Writes a timeline of thorin's work as Chrome trace-event JSON - open it in @c chrome://tracing or Perfetto.
+ * Enable it via @p enable or by setting the environment variable @c THORIN_TRACE to the name of the output file.
+ * While it is disabled, a @p Span costs a single check.
+ */
+class Trace {
+public:
+    Trace() = delete;
+
+    /// Starts writing to @p filename - returns @c false if the file can't be opened.
+    static bool enable(const std::string& filename);
+    /// Finishes the file - this also happens at exit.
+    static void disable();
+    static bool is_enabled();
+
+    /// Records the time from construction to destruction as a complete event.
+    class Span {
+    public:
+        Span(const Span&) = delete;
+        Span& operator=(const Span&) = delete;
+
+        /// Use @p name to set names which have to be computed - only if the @p Trace is enabled.
+        Span(const char* category, const char* name = nullptr);
+        ~Span();
+
+        /// Is the @p Trace enabled? Use this to skip computing names and arguments otherwise.
+        explicit operator bool() const { return active_; }
+        Span& name(std::string name) { name_ = std::move(name); return *this; }
+        Span& arg(const char* key, const std::string& value);
+        Span& arg(const char* key, uint64_t value);
+
+    private:
+        bool active_;
+        const char* category_;
+        std::string name_;
+        std::string args_;
+        double start_;
+    };
+};
+
+}
+
+#endif
@@ -17,6 +17,7 @@ struct GIDLt {
 
 template<class T>
 struct GIDHash {
+    static const HashStats::Category category = HashStats::GIDs;
     static uint64_t hash(T n) { return thorin::murmur3(n->gid()); }
     static bool eq(T a, T b) { return a == b; }
     static T sentinel() { return T(1); }
@@ -102,6 +103,7 @@ template <class Type>
 class TypeTableBase {
 public:
     struct TypeHash {
+        static const HashStats::Category category = HashStats::Types;
         static uint64_t hash(const Type* t) { return t->hash(); }
         static bool eq(const Type* t1, const Type* t2) { return t2->equal(t1); }
         static const Type* sentinel() { return (const Type*)(1); }
@@ -1,5 +1,7 @@
 #include "thorin/world.h"
 
+#include <algorithm>
+#include <cstdlib>
 #include <fstream>
 
 #include "thorin/def.h"
@@ -8,19 +10,11 @@
 #include "thorin/type.h"
 #include "thorin/analyses/scope.h"
 #include "thorin/transform/cleanup_world.h"
-#include "thorin/transform/clone_bodies.h"
-#include "thorin/transform/closure_conversion.h"
-#include "thorin/transform/codegen_prepare.h"
-#include "thorin/transform/dead_load_opt.h"
-#include "thorin/transform/flatten_tuples.h"
-#include "thorin/transform/rewrite_flow_graphs.h"
-#include "thorin/transform/hoist_enters.h"
-#include "thorin/transform/inliner.h"
-#include "thorin/transform/lift_builtins.h"
-#include "thorin/transform/partial_evaluation.h"
-#include "thorin/transform/split_slots.h"
+#include "thorin/transform/pass_manager.h"
 #include "thorin/util/array.h"
 #include "thorin/util/log.h"
+#include "thorin/util/memory_stats.h"
+#include "thorin/util/statistic.h"
 
 #if (defined(__clang__) || defined(__GNUC__)) && (defined(__x86_64__) || defined(__i386__))
 #define THORIN_BREAK asm("int3");
@@ -49,6 +43,19 @@ World::World(std::string name)
 }
 
 World::~World() {
+    // the counters are shared by all worlds - so start over after each dump
+    if (std::getenv("THORIN_STATS")) {
+        Statistic::dump();
+        Statistic::reset_all();
+    }
+#if THORIN_ENABLE_PROFILING
+    if (std::getenv("THORIN_HASH_STATS")) {
+        HashStats::dump();
+        HashStats::reset();
+    }
+#endif
+    if (std::getenv("THORIN_MEMORY_STATS"))
+        memory_stats().dump(std::cerr);
     for (auto continuation : continuations_) delete continuation;
     for (auto primop : primops_) delete primop;
 }
@@ -360,26 +367,141 @@ const Def* World::arithop(ArithOpTag tag, const Def* a, const Def* b, Debug dbg)
         }
     }
 
-    // normalize: try to reorder same ops to have the literal/vector on the left-most side
-    if (is_associative(tag) && is_type_i(a->type())) {
-        auto a_same = a->isa<ArithOp>() && a->as<ArithOp>()->arithop_tag() == tag ? a->as<ArithOp>() : nullptr;
-        auto b_same = b->isa<ArithOp>() && b->as<ArithOp>()->arithop_tag() == tag ? b->as<ArithOp>() : nullptr;
+    if (is_type_i(type)) {
+        if (auto result = reassociate(tag, a, b, dbg))
+            return result;
+    }
+
+    return cse(new ArithOp(tag, a, b, dbg));
+}
+
+/// Collects the operands of a chain of @p tag operations - literals are folded into @p lit.
+static void flatten(ArithOpTag tag, const Def* def, std::vector<const Def*>& ops, const Def*& lit, World& world, Debug dbg) {
+    static const size_t max_ops = 16;
+
+    auto arithop = def->isa<ArithOp>();
+    if (arithop && arithop->arithop_tag() == tag && ops.size() + 2 <= max_ops) {
+        flatten(tag, arithop->lhs(), ops, lit, world, dbg);
+        flatten(tag, arithop->rhs(), ops, lit, world, dbg);
+    } else if (def->isa<PrimLit>()) {
+        lit = lit ? world.arithop(tag, lit, def, dbg) : def;
+    } else {
+        ops.push_back(def);
+    }
+}
+
+/**
+ * Canonicalizes chains of associative operations on integers.
+ * Chains of associative and commutative operations on scalar precise integers are reassociated:
+ * All literals are combined into a single one on the left-most side; the remaining operands form a left-leaning chain
+ * sorted by gid.
+ * Thus, <tt>(a + 1) + 2</tt> yields <tt>3 + a</tt> and <tt>(b + a) + c</tt> as well as <tt>(c + a) + b</tt> yield the
+ * same @p Def.
+ * Quick integers must not overflow - reordering may introduce an overflow which the source doesn't have.
+ * Hence, quick integers and vectors are merely normalized such that literals/vectors of a chain move to the left-most side.
+ * Returns @c nullptr if nothing is to be done.
+ */
+const Def* World::reassociate(ArithOpTag tag, const Def* a, const Def* b, Debug dbg) {
+    auto llit = a->isa<PrimLit>();
+    auto rlit = b->isa<PrimLit>();
+    auto larith = a->isa<ArithOp>();
+    auto rarith = b->isa<ArithOp>();
+
+    if (!is_type_p(a->type()->as<PrimType>()->primtype_tag()) || vector_length(a) != 1) {
+        if (!is_associative(tag))
+            return nullptr;
+
+        auto a_same = larith && larith->arithop_tag() == tag ? larith : nullptr;
+        auto b_same = rarith && rarith->arithop_tag() == tag ? rarith : nullptr;
         auto a_lhs_lv = a_same && (a_same->lhs()->isa<PrimLit>() || a_same->lhs()->isa<Vector>()) ? a_same->lhs() : nullptr;
         auto b_lhs_lv = b_same && (b_same->lhs()->isa<PrimLit>() || b_same->lhs()->isa<Vector>()) ? b_same->lhs() : nullptr;
 
         if (is_commutative(tag)) {
             if (a_lhs_lv && b_lhs_lv)
                 return arithop(tag, arithop(tag, a_lhs_lv, b_lhs_lv, dbg), arithop(tag, a_same->rhs(), b_same->rhs(), dbg), dbg);
-            if ((llit || lvec) && b_lhs_lv)
+            if ((llit || a->isa<Vector>()) && b_lhs_lv)
                 return arithop(tag, arithop(tag, a, b_lhs_lv, dbg), b_same->rhs(), dbg);
             if (b_lhs_lv)
                 return arithop(tag, b_lhs_lv, arithop(tag, a, b_same->rhs(), dbg), dbg);
         }
         if (a_lhs_lv)
             return arithop(tag, a_lhs_lv, arithop(tag, a_same->rhs(), b, dbg), dbg);
+        return nullptr;
     }
 
-    return cse(new ArithOp(tag, a, b, dbg));
+    // (c1 + x) - c2 -> (c1 - c2) + x
+    if (tag == ArithOp_sub && rlit && larith && larith->arithop_tag() == ArithOp_add && larith->lhs()->isa<PrimLit>())
+        return arithop_add(arithop_sub(larith->lhs(), b, dbg), larith->rhs(), dbg);
+    // (x - c1) - c2 -> x - (c1 + c2)
+    if (tag == ArithOp_sub && rlit && larith && larith->arithop_tag() == ArithOp_sub && larith->rhs()->isa<PrimLit>())
+        return arithop_sub(larith->lhs(), arithop_add(larith->rhs(), b, dbg), dbg);
+    // c2 + (x - c1) -> (c2 - c1) + x
+    if (tag == ArithOp_add && llit && rarith && rarith->arithop_tag() == ArithOp_sub && rarith->rhs()->isa<PrimLit>())
+        return arithop_add(arithop_sub(a, rarith->rhs(), dbg), rarith->lhs(), dbg);
+
+    if (!is_associative(tag) || !is_commutative(tag))
+        return nullptr;
+
+    std::vector<const Def*> ops;
+    const Def* lit = nullptr;
+    flatten(tag, a, ops, lit, *this, dbg);
+    flatten(tag, b, ops, lit, *this, dbg);
+    std::stable_sort(ops.begin(), ops.end(), [] (const Def* x, const Def* y) { return x->gid() < y->gid(); });
+
+    // equal operands are adjacent now
+    if (tag == ArithOp_and || tag == ArithOp_or) {
+        ops.erase(std::unique(ops.begin(), ops.end()), ops.end());
+    } else if (tag == ArithOp_xor) {
+        std::vector<const Def*> remaining;
+        for (auto op : ops) {
+            if (!remaining.empty() && remaining.back() == op)
+                remaining.pop_back();
+            else
+                remaining.push_back(op);
+        }
+        ops.swap(remaining);
+    }
+
+    auto type = a->type()->as<PrimType>()->primtype_tag();
+    if (tag == ArithOp_add) {
+        // x + x + x -> 3 * x
+        std::vector<const Def*> remaining;
+        for (size_t i = 0, e = ops.size(); i != e;) {
+            size_t n = 1;
+            while (i + n != e && ops[i + n] == ops[i]) ++n;
+            remaining.push_back(n == 1 ? ops[i] : arithop_mul(literal(type, u64(n), dbg), ops[i], dbg));
+            i += n;
+        }
+        if (remaining.size() != ops.size()) {
+            ops.swap(remaining);
+            std::stable_sort(ops.begin(), ops.end(), [] (const Def* x, const Def* y) { return x->gid() < y->gid(); });
+        }
+    }
+
+    if (lit) {
+        switch (tag) {
+            case ArithOp_mul:
+            case ArithOp_and: if (is_zero(lit)) return lit; break;
+            case ArithOp_or:  if (is_allset(lit)) return lit; break;
+            default: break;
+        }
+        switch (tag) {
+            case ArithOp_add:
+            case ArithOp_or:
+            case ArithOp_xor: if (is_zero(lit)) lit = nullptr; break;
+            case ArithOp_mul: if (is_one(lit)) lit = nullptr; break;
+            case ArithOp_and: if (is_allset(lit)) lit = nullptr; break;
+            default: break;
+        }
+    }
+
+    if (ops.empty())
+        return lit ? lit : zero(type, dbg);
+
+    auto result = ops.front();
+    for (size_t i = 1, e = ops.size(); i != e; ++i)
+        result = cse(new ArithOp(tag, result, ops[i], dbg));
+    return lit ? cse(new ArithOp(tag, lit, result, dbg)) : result;
 }
 
 const Def* World::arithop_not(const Def* def, Debug dbg) { return arithop_xor(allset(def->type(), dbg, vector_length(def)), def, dbg); }
@@ -900,6 +1022,7 @@ Continuation* World::continuation(const FnType* fn, CC cc, Intrinsic intrinsic,
     auto l = new Continuation(fn, cc, intrinsic, dbg);
     THORIN_CHECK_BREAK(l->gid());
     continuations_.insert(l);
+    l->touch();
 
     size_t i = 0;
     for (auto op : fn->ops()) {
@@ -952,10 +1075,33 @@ Array<Continuation*> World::copy_continuations() const {
     return result;
 }
 
+void World::record_modified(bool flag) {
+    modified_.clear();
+    recorded_since_ = flag ? epoch_ : size_t(-1);
+}
+
+std::vector<Continuation*> World::modified_since(size_t epoch) const {
+    assert(is_recorded_since(epoch));
+    auto i = std::upper_bound(modified_.begin(), modified_.end(), epoch,
+                              [] (size_t epoch, const std::pair<size_t, Continuation*>& p) { return epoch < p.first; });
+    ContinuationSet done;
+    std::vector<Continuation*> result;
+    for (auto e = modified_.end(); i != e; ++i) {
+        if (done.emplace(i->second).second)
+            result.push_back(i->second);
+    }
+    return result;
+}
+
+THORIN_STATISTIC(num_cse_lookups, "cse", "primops looked up");
+THORIN_STATISTIC(num_cse_hits,    "cse", "primops that already existed");
+
 const Def* World::cse_base(const PrimOp* primop) {
     THORIN_CHECK_BREAK(primop->gid());
+    ++num_cse_lookups;
     auto i = primops_.find(primop);
     if (i != primops_.end()) {
+        ++num_cse_hits;
         primop->unregister_uses();
         --Def::gid_counter_;
         delete primop;
@@ -973,21 +1119,9 @@ const Def* World::cse_base(const PrimOp* primop) {
 
 void World::cleanup() { cleanup_world(*this); }
 
-void World::opt() {
-    cleanup();
-    while (partial_evaluation(*this, true)); // lower2cff
-    flatten_tuples(*this);
-    clone_bodies(*this);
-    split_slots(*this);
-    closure_conversion(*this);
-    lift_builtins(*this);
-    inliner(*this);
-    hoist_enters(*this);
-    dead_load_opt(*this);
-    cleanup();
-    rewrite_flow_graphs(*this);
-    codegen_prepare(*this);
-}
+void World::opt(int level) { PassManager(*this).add_level(level).run(); }
+
+MemoryStats World::memory_stats() const { return MemoryStats(*this); }
 
 /*
  * stream
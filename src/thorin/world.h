@@ -16,6 +16,9 @@
 
 namespace thorin {
 
+class MemoryStats;
+class PassReport;
+
 /**
  * The World represents the whole program and manages creation and destruction of Thorin nodes.
  * In particular, the following things are done by this class:
@@ -173,7 +176,8 @@ public:
 
     /// Performs dead code, unreachable code and unused type elimination.
     void cleanup();
-    void opt();
+    /// Runs the pipeline of optimization @p level - see @p PassManager::add_level.
+    void opt(int level = 2);
 
     // getters
 
@@ -183,13 +187,29 @@ public:
     Array<Continuation*> copy_continuations() const;
     const ContinuationSet& externals() const { return externals_; }
     bool empty() const { return continuations().size() <= 2; } // TODO rework intrinsic stuff. 2 = branch + end_scope
+    /// Each modification of a @p Continuation starts a new epoch - see @p Continuation::is_modified_since.
+    size_t epoch() const { return epoch_; }
+    /// Starts or stops recording the modified @p Continuation%s - see @p modified_since.
+    void record_modified(bool flag = true);
+    /// Have all modifications after @p epoch been recorded?
+    bool is_recorded_since(size_t epoch) const { return recorded_since_ <= epoch; }
+    /// All @p Continuation%s modified after @p epoch in the order of their modification - requires @p is_recorded_since.
+    std::vector<Continuation*> modified_since(size_t epoch) const;
 
     // other stuff
 
     void mark_pe_done(bool flag = true) { pe_done_ = flag; }
     bool is_pe_done() const { return pe_done_; }
-    void add_external(Continuation* continuation) { externals_.insert(continuation); }
-    void remove_external(Continuation* continuation) { externals_.erase(continuation); }
+    /// Opts into @p aos_to_soa during <tt>opt(3)</tt>.
+    void enable_soa(bool flag = true) { soa_ = flag; }
+    bool soa() const { return soa_; }
+    /// Passes and @p cleanup iterations are recorded in @p report while it is attached - @c nullptr detaches it.
+    void set_pass_report(PassReport* report) { pass_report_ = report; }
+    PassReport* pass_report() const { return pass_report_; }
+    /// Walks all nodes and reports their live bytes by category - see @p MemoryStats.
+    MemoryStats memory_stats() const;
+    void add_external(Continuation* continuation) { externals_.insert(continuation); continuation->touch(); }
+    void remove_external(Continuation* continuation) { externals_.erase(continuation); continuation->touch(); }
     bool is_external(const Continuation* continuation) { return externals().contains(const_cast<Continuation*>(continuation)); }
 #if THORIN_ENABLE_CHECKS
     void breakpoint(size_t number) { breakpoints_.insert(number); }
@@ -214,6 +234,11 @@ public:
         swap(w1.branch_,        w2.branch_);
         swap(w1.end_scope_,     w2.end_scope_);
         swap(w1.pe_done_,       w2.pe_done_);
+        swap(w1.soa_,           w2.soa_);
+        swap(w1.pass_report_,   w2.pass_report_);
+        swap(w1.epoch_,         w2.epoch_);
+        swap(w1.modified_,      w2.modified_);
+        swap(w1.recorded_since_, w2.recorded_since_);
 
 #if THORIN_ENABLE_CHECKS
         swap(w1.breakpoints_,   w2.breakpoints_);
@@ -224,6 +249,7 @@ public:
 private:
     const Param* param(const Type* type, Continuation* continuation, size_t index, Debug dbg);
     const Def* try_fold_aggregate(const Aggregate*);
+    const Def* reassociate(ArithOpTag tag, const Def* lhs, const Def* rhs, Debug dbg);
     const Def* cse_base(const PrimOp*);
     template<class T> const T* cse(const T* primop) { return cse_base(primop)->template as<T>(); }
 
@@ -234,6 +260,11 @@ private:
     Continuation* branch_;
     Continuation* end_scope_;
     bool pe_done_ = false;
+    bool soa_ = false;
+    PassReport* pass_report_ = nullptr;
+    size_t epoch_ = 0;
+    std::vector<std::pair<size_t, Continuation*>> modified_; ///< each recorded modification with its epoch
+    size_t recorded_since_ = size_t(-1);
 #if THORIN_ENABLE_CHECKS
     Breakpoints breakpoints_;
     bool track_history_ = false;